@@ -0,0 +1,173 @@
+#include "analyzer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "symbol.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+namespace {
+
+bool is_form(const ValuePtr& expr, Symbol name) {
+  return expr->is_cons() && expr->car()->is_symbol() &&
+         expr->car()->as_symbol() == name;
+}
+
+// Collects the names bound by define forms that would execute in the frame of
+// the enclosing lambda, i.e. anywhere in `expr` except under quote or inside a
+// nested lambda.
+void collect_defines(const ValuePtr& expr, std::vector<Symbol>& defined) {
+  if (!expr->is_cons() || is_form(expr, kQuote) || is_form(expr, kLambda)) {
+    return;
+  }
+
+  ValuePtr current = expr;
+  if (is_form(expr, kDefine) && expr->cdr()->is_cons()) {
+    ValuePtr const name = expr->cdr()->car();
+    if (name->is_symbol()) {
+      defined.push_back(name->as_symbol());
+    }
+    current = expr->cdr()->cdr();
+  }
+
+  for (; current->is_cons(); current = current->cdr()) {
+    collect_defines(current->car(), defined);
+  }
+}
+
+}  // namespace
+
+ValuePtr Analyzer::analyze(const ValuePtr& expr) {
+  if (!expr) {
+    return expr;
+  }
+  if (expr->is_symbol()) {
+    return analyze_symbol(expr);
+  }
+  if (expr->is_cons()) {
+    return analyze_list(expr);
+  }
+  return expr;
+}
+
+ValuePtr Analyzer::analyze_symbol(const ValuePtr& expr) const {
+  Symbol const name = expr->as_symbol();
+
+  for (std::size_t depth = 0; depth < scopes.size(); ++depth) {
+    const Scope& scope = scopes[scopes.size() - 1 - depth];
+
+    // Match Environment::define/lookup: the last occurrence of a repeated
+    // parameter name wins.
+    auto param = std::find(scope.params.rbegin(), scope.params.rend(), name);
+    if (param != scope.params.rend()) {
+      auto const slot = std::distance(param, scope.params.rend()) - 1;
+      return make_local_ref(name, static_cast<std::uint32_t>(depth),
+                            static_cast<std::uint32_t>(slot));
+    }
+
+    // A define in this frame may or may not have run yet, so the binding
+    // can only be found by name.
+    if (std::find(scope.defined.begin(), scope.defined.end(), name) !=
+        scope.defined.end()) {
+      return expr;
+    }
+  }
+
+  // Not bound by any enclosing lambda, so a global. Inside a lambda body the
+  // reference may be evaluated many times and is worth caching; at top
+  // level it runs once.
+  if (!scopes.empty()) {
+    return make_global_ref(name);
+  }
+  return expr;
+}
+
+ValuePtr Analyzer::analyze_list(const ValuePtr& expr) {
+  if (is_form(expr, kQuote)) {
+    return expr;
+  }
+
+  if (is_form(expr, kLambda)) {
+    return analyze_lambda(expr);
+  }
+
+  if (is_form(expr, kDefine)) {
+    // Leave the name being defined as a symbol; only the value is analyzed.
+    ValuePtr const args = expr->cdr();
+    if (!args->is_cons()) {
+      return expr;
+    }
+    ValuePtr const value = analyze_elements(args->cdr());
+    if (value == args->cdr()) {
+      return expr;
+    }
+    return make_cons(expr->car(), make_cons(args->car(), value));
+  }
+
+  if (is_form(expr, kIf)) {
+    ValuePtr const args = analyze_elements(expr->cdr());
+    return args == expr->cdr() ? expr : make_cons(expr->car(), args);
+  }
+
+  return analyze_elements(expr);
+}
+
+ValuePtr Analyzer::analyze_lambda(const ValuePtr& expr) {
+  ValuePtr const args = expr->cdr();
+  if (!args->is_cons()) {
+    return expr;
+  }
+
+  Scope scope;
+  ValuePtr current = args->car();
+  for (; current->is_cons(); current = current->cdr()) {
+    if (!current->car()->is_symbol()) {
+      return expr;  // Malformed; let the evaluator report it.
+    }
+    scope.params.push_back(current->car()->as_symbol());
+  }
+
+  ValuePtr const body = args->cdr();
+  for (current = body; current->is_cons(); current = current->cdr()) {
+    collect_defines(current->car(), scope.defined);
+  }
+
+  scopes.push_back(std::move(scope));
+  ValuePtr const new_body = analyze_elements(body);
+  scopes.pop_back();
+
+  if (new_body == body) {
+    return expr;
+  }
+  return make_cons(expr->car(), make_cons(args->car(), new_body));
+}
+
+ValuePtr Analyzer::analyze_elements(const ValuePtr& list) {
+  std::vector<ValuePtr> elements;
+  bool changed = false;
+
+  ValuePtr current = list;
+  for (; current->is_cons(); current = current->cdr()) {
+    ValuePtr const element = current->car();
+    elements.push_back(analyze(element));
+    changed = changed || elements.back() != element;
+  }
+
+  if (!changed) {
+    return list;
+  }
+
+  // Rebuild the spine, keeping any improper tail as-is.
+  ValuePtr result = current;
+  for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
+    result = make_cons(*it, result);
+  }
+  return result;
+}
+
+}  // namespace lisp
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "symbol.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+// Resolves variable references in a parsed top-level form before it is
+// evaluated. A reference to a lambda parameter becomes a LOCAL_REF holding its
+// (depth, slot) address, so the evaluator can load it by index instead of
+// searching frames by name. A reference from a lambda body to a global becomes
+// a GLOBAL_REF, which caches the global's binding once it has been found.
+// Names bound by a define inside a lambda body, top-level references and
+// quoted data are left as symbols for lookup at run time.
+//
+// The input is never modified: lists containing rewritten references are
+// copied, and unchanged subtrees are shared with the original.
+class Analyzer {
+ private:
+  struct Scope {
+    std::vector<Symbol> params;
+    std::vector<Symbol> defined;
+  };
+
+  std::vector<Scope> scopes;
+
+  ValuePtr analyze_symbol(const ValuePtr& expr) const;
+  ValuePtr analyze_list(const ValuePtr& expr);
+  ValuePtr analyze_lambda(const ValuePtr& expr);
+  ValuePtr analyze_elements(const ValuePtr& list);
+
+ public:
+  ValuePtr analyze(const ValuePtr& expr);
+};
+
+}  // namespace lisp
@@ -0,0 +1,426 @@
+#include "bigint.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lisp {
+
+namespace {
+
+using Limbs = BigInt::Limbs;
+using Span = std::span<const std::uint32_t>;
+
+constexpr int kLimbBits = 32;
+constexpr std::uint64_t kLimbBase = std::uint64_t{1} << kLimbBits;
+
+// Operands with fewer limbs than this are multiplied by the schoolbook
+// method, which is faster than Karatsuba's extra additions at small sizes.
+constexpr std::size_t kKaratsubaThreshold = 32;
+
+// Decimal digits handled per step when converting to and from text.
+constexpr std::uint32_t kDecimalChunk = 1'000'000'000;
+constexpr int kDecimalChunkDigits = 9;
+
+//
+// Magnitude arithmetic. Magnitudes are unsigned, least significant limb
+// first; results are trimmed of leading zero limbs.
+//
+
+void trim(Limbs& limbs) {
+  while (!limbs.empty() && limbs.back() == 0) {
+    limbs.pop_back();
+  }
+}
+
+Span trimmed(Span limbs) {
+  while (!limbs.empty() && limbs.back() == 0) {
+    limbs = limbs.first(limbs.size() - 1);
+  }
+  return limbs;
+}
+
+std::strong_ordering compare_magnitudes(Span lhs, Span rhs) {
+  if (lhs.size() != rhs.size()) {
+    return lhs.size() <=> rhs.size();
+  }
+  for (std::size_t i = lhs.size(); i-- > 0;) {
+    if (lhs[i] != rhs[i]) {
+      return lhs[i] <=> rhs[i];
+    }
+  }
+  return std::strong_ordering::equal;
+}
+
+Limbs add_magnitudes(Span lhs, Span rhs) {
+  if (lhs.size() < rhs.size()) {
+    std::swap(lhs, rhs);
+  }
+  Limbs result(lhs.size() + 1);
+  std::uint64_t carry = 0;
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    std::uint64_t const sum =
+        std::uint64_t{lhs[i]} + (i < rhs.size() ? rhs[i] : 0) + carry;
+    result[i] = static_cast<std::uint32_t>(sum);
+    carry = sum >> kLimbBits;
+  }
+  result[lhs.size()] = static_cast<std::uint32_t>(carry);
+  trim(result);
+  return result;
+}
+
+// Requires lhs >= rhs.
+Limbs subtract_magnitudes(Span lhs, Span rhs) {
+  Limbs result(lhs.size());
+  std::int64_t borrow = 0;
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    std::int64_t difference = std::int64_t{lhs[i]} - borrow -
+                              (i < rhs.size() ? std::int64_t{rhs[i]} : 0);
+    borrow = difference < 0 ? 1 : 0;
+    if (difference < 0) {
+      difference += static_cast<std::int64_t>(kLimbBase);
+    }
+    result[i] = static_cast<std::uint32_t>(difference);
+  }
+  trim(result);
+  return result;
+}
+
+// Adds `addend` into `target` starting at limb `offset`; `target` must be
+// long enough to hold the result.
+void add_into(Limbs& target, Span addend, std::size_t offset) {
+  std::uint64_t carry = 0;
+  std::size_t i = 0;
+  for (; i < addend.size(); ++i) {
+    std::uint64_t const sum =
+        std::uint64_t{target[offset + i]} + addend[i] + carry;
+    target[offset + i] = static_cast<std::uint32_t>(sum);
+    carry = sum >> kLimbBits;
+  }
+  for (; carry != 0; ++i) {
+    std::uint64_t const sum = std::uint64_t{target[offset + i]} + carry;
+    target[offset + i] = static_cast<std::uint32_t>(sum);
+    carry = sum >> kLimbBits;
+  }
+}
+
+Limbs schoolbook_multiply(Span lhs, Span rhs) {
+  Limbs result(lhs.size() + rhs.size());
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    std::uint64_t carry = 0;
+    for (std::size_t j = 0; j < rhs.size(); ++j) {
+      std::uint64_t const product =
+          std::uint64_t{lhs[i]} * rhs[j] + result[i + j] + carry;
+      result[i + j] = static_cast<std::uint32_t>(product);
+      carry = product >> kLimbBits;
+    }
+    result[i + rhs.size()] = static_cast<std::uint32_t>(carry);
+  }
+  trim(result);
+  return result;
+}
+
+Limbs multiply_magnitudes(Span lhs, Span rhs);
+
+// Karatsuba: with both operands split at limb `half` into high and low
+// parts, lhs * rhs = high * B^2h + middle * B^h + low, where
+// middle = (lhs_high + lhs_low) * (rhs_high + rhs_low) - high - low.
+Limbs karatsuba_multiply(Span lhs, Span rhs) {
+  std::size_t const half = std::max(lhs.size(), rhs.size()) / 2;
+  auto const split = [half](Span limbs) {
+    return limbs.size() <= half
+               ? std::pair(trimmed(limbs), Span())
+               : std::pair(trimmed(limbs.first(half)), limbs.subspan(half));
+  };
+  auto const [lhs_low, lhs_high] = split(lhs);
+  auto const [rhs_low, rhs_high] = split(rhs);
+
+  Limbs const low = multiply_magnitudes(lhs_low, rhs_low);
+  Limbs const high = multiply_magnitudes(lhs_high, rhs_high);
+  Limbs middle = multiply_magnitudes(add_magnitudes(lhs_low, lhs_high),
+                                     add_magnitudes(rhs_low, rhs_high));
+  middle = subtract_magnitudes(middle, low);
+  middle = subtract_magnitudes(middle, high);
+
+  Limbs result(lhs.size() + rhs.size() + 1);
+  add_into(result, low, 0);
+  add_into(result, middle, half);
+  add_into(result, high, 2 * half);
+  trim(result);
+  return result;
+}
+
+Limbs multiply_magnitudes(Span lhs, Span rhs) {
+  if (lhs.empty() || rhs.empty()) {
+    return {};
+  }
+  if (std::min(lhs.size(), rhs.size()) < kKaratsubaThreshold) {
+    return schoolbook_multiply(lhs, rhs);
+  }
+  return karatsuba_multiply(lhs, rhs);
+}
+
+// Divides `limbs` in place by a single limb and returns the remainder.
+std::uint32_t divide_by_limb(Limbs& limbs, std::uint32_t divisor) {
+  std::uint64_t remainder = 0;
+  for (std::size_t i = limbs.size(); i-- > 0;) {
+    std::uint64_t const current = (remainder << kLimbBits) | limbs[i];
+    limbs[i] = static_cast<std::uint32_t>(current / divisor);
+    remainder = current % divisor;
+  }
+  trim(limbs);
+  return static_cast<std::uint32_t>(remainder);
+}
+
+// Knuth's Algorithm D (TAOCP 4.3.1) for a divisor of at least two limbs:
+// the divisor is normalized so that its top bit is set, which keeps each
+// estimated quotient limb within two of the true value.
+void divide_magnitudes(Span dividend, Span divisor, Limbs& quotient,
+                       Limbs& remainder) {
+  std::size_t const n = divisor.size();
+  std::size_t const m = dividend.size() - n;
+  int const shift = std::countl_zero(divisor.back());
+
+  auto const normalize = [shift](Span limbs, std::size_t size) {
+    Limbs result(size);
+    for (std::size_t i = 0; i < limbs.size(); ++i) {
+      std::uint64_t const shifted = std::uint64_t{limbs[i]} << shift;
+      result[i] |= static_cast<std::uint32_t>(shifted);
+      if (i + 1 < size) {
+        result[i + 1] = static_cast<std::uint32_t>(shifted >> kLimbBits);
+      }
+    }
+    return result;
+  };
+  Limbs const v = normalize(divisor, n);
+  Limbs u = normalize(dividend, dividend.size() + 1);
+
+  quotient.assign(m + 1, 0);
+  for (std::size_t j = m + 1; j-- > 0;) {
+    std::uint64_t const top = (std::uint64_t{u[j + n]} << kLimbBits) |
+                              u[j + n - 1];
+    std::uint64_t estimate = top / v[n - 1];
+    std::uint64_t rest = top % v[n - 1];
+    while (estimate >= kLimbBase ||
+           estimate * v[n - 2] > ((rest << kLimbBits) | u[j + n - 2])) {
+      --estimate;
+      rest += v[n - 1];
+      if (rest >= kLimbBase) {
+        break;
+      }
+    }
+
+    // Subtract estimate * v from the current window of u.
+    std::int64_t borrow = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      std::uint64_t const product = estimate * v[i];
+      std::int64_t const difference =
+          std::int64_t{u[i + j]} - borrow -
+          static_cast<std::int64_t>(product & (kLimbBase - 1));
+      u[i + j] = static_cast<std::uint32_t>(difference);
+      borrow = static_cast<std::int64_t>(product >> kLimbBits) -
+               (difference >> kLimbBits);
+    }
+    std::int64_t const difference = std::int64_t{u[j + n]} - borrow;
+    u[j + n] = static_cast<std::uint32_t>(difference);
+
+    // The estimate was one too large: add v back.
+    if (difference < 0) {
+      --estimate;
+      std::uint64_t carry = 0;
+      for (std::size_t i = 0; i < n; ++i) {
+        std::uint64_t const sum = std::uint64_t{u[i + j]} + v[i] + carry;
+        u[i + j] = static_cast<std::uint32_t>(sum);
+        carry = sum >> kLimbBits;
+      }
+      u[j + n] += static_cast<std::uint32_t>(carry);
+    }
+    quotient[j] = static_cast<std::uint32_t>(estimate);
+  }
+  trim(quotient);
+
+  remainder.assign(n, 0);
+  for (std::size_t i = 0; i < n; ++i) {
+    remainder[i] = u[i] >> shift;
+    if (shift != 0) {
+      remainder[i] |= static_cast<std::uint32_t>(
+          std::uint64_t{u[i + 1]} << (kLimbBits - shift));
+    }
+  }
+  trim(remainder);
+}
+
+}  // namespace
+
+BigInt::BigInt(bool negative, Limbs limbs)
+    : negative(negative && !limbs.empty()), limbs(std::move(limbs)) {}
+
+BigInt::BigInt(std::int64_t value) : negative(value < 0) {
+  // Negate in unsigned arithmetic so that INT64_MIN does not overflow.
+  std::uint64_t magnitude = static_cast<std::uint64_t>(value);
+  if (negative) {
+    magnitude = ~magnitude + 1;
+  }
+  for (; magnitude != 0; magnitude >>= kLimbBits) {
+    limbs.push_back(static_cast<std::uint32_t>(magnitude));
+  }
+}
+
+std::optional<BigInt> BigInt::parse(std::string_view text) {
+  bool negative = false;
+  if (!text.empty() && (text.front() == '-' || text.front() == '+')) {
+    negative = text.front() == '-';
+    text.remove_prefix(1);
+  }
+  if (text.empty()) {
+    return std::nullopt;
+  }
+
+  Limbs limbs;
+  // The first chunk takes the leftover digits so the rest are full chunks.
+  std::size_t chunk_size = text.size() % kDecimalChunkDigits;
+  if (chunk_size == 0) {
+    chunk_size = kDecimalChunkDigits;
+  }
+  for (std::size_t start = 0; start < text.size(); start += chunk_size) {
+    if (start != 0) {
+      chunk_size = kDecimalChunkDigits;
+    }
+    std::uint64_t carry = 0;
+    std::uint32_t scale = 1;
+    for (char const digit : text.substr(start, chunk_size)) {
+      if (digit < '0' || digit > '9') {
+        return std::nullopt;
+      }
+      carry = carry * 10 + static_cast<std::uint32_t>(digit - '0');
+      scale *= 10;
+    }
+    for (std::uint32_t& limb : limbs) {
+      std::uint64_t const value = std::uint64_t{limb} * scale + carry;
+      limb = static_cast<std::uint32_t>(value);
+      carry = value >> kLimbBits;
+    }
+    if (carry != 0) {
+      limbs.push_back(static_cast<std::uint32_t>(carry));
+    }
+  }
+  return BigInt(negative, std::move(limbs));
+}
+
+std::optional<std::int64_t> BigInt::to_int64() const {
+  if (limbs.size() > 2) {
+    return std::nullopt;
+  }
+  std::uint64_t magnitude = 0;
+  for (std::size_t i = limbs.size(); i-- > 0;) {
+    magnitude = (magnitude << kLimbBits) | limbs[i];
+  }
+  auto const limit =
+      static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+  if (negative) {
+    if (magnitude > limit + 1) {
+      return std::nullopt;
+    }
+    return static_cast<std::int64_t>(~magnitude + 1);
+  }
+  if (magnitude > limit) {
+    return std::nullopt;
+  }
+  return static_cast<std::int64_t>(magnitude);
+}
+
+double BigInt::to_double() const {
+  double result = 0.0;
+  for (std::size_t i = limbs.size(); i-- > 0;) {
+    result = result * static_cast<double>(kLimbBase) + limbs[i];
+  }
+  return negative ? -result : result;
+}
+
+std::string BigInt::to_string() const {
+  if (limbs.empty()) {
+    return "0";
+  }
+
+  // Peel off nine decimal digits at a time, least significant first.
+  std::vector<std::uint32_t> chunks;
+  Limbs rest = limbs;
+  while (!rest.empty()) {
+    chunks.push_back(divide_by_limb(rest, kDecimalChunk));
+  }
+
+  std::string result = negative ? "-" : "";
+  result += std::to_string(chunks.back());
+  for (std::size_t i = chunks.size() - 1; i-- > 0;) {
+    std::string const digits = std::to_string(chunks[i]);
+    result.append(kDecimalChunkDigits - digits.size(), '0');
+    result += digits;
+  }
+  return result;
+}
+
+BigInt BigInt::operator-() const { return BigInt(!negative, limbs); }
+
+BigInt operator+(const BigInt& lhs, const BigInt& rhs) {
+  if (lhs.negative == rhs.negative) {
+    return BigInt(lhs.negative, add_magnitudes(lhs.limbs, rhs.limbs));
+  }
+  if (compare_magnitudes(lhs.limbs, rhs.limbs) >= 0) {
+    return BigInt(lhs.negative, subtract_magnitudes(lhs.limbs, rhs.limbs));
+  }
+  return BigInt(rhs.negative, subtract_magnitudes(rhs.limbs, lhs.limbs));
+}
+
+BigInt operator-(const BigInt& lhs, const BigInt& rhs) { return lhs + -rhs; }
+
+BigInt operator*(const BigInt& lhs, const BigInt& rhs) {
+  return BigInt(lhs.negative != rhs.negative,
+                multiply_magnitudes(lhs.limbs, rhs.limbs));
+}
+
+void BigInt::divide(const BigInt& dividend, const BigInt& divisor,
+                    BigInt& quotient, BigInt& remainder) {
+  if (divisor.is_zero()) {
+    throw std::domain_error("BigInt division by zero");
+  }
+
+  Limbs quotient_limbs;
+  Limbs remainder_limbs;
+  if (compare_magnitudes(dividend.limbs, divisor.limbs) < 0) {
+    remainder_limbs = dividend.limbs;
+  } else if (divisor.limbs.size() == 1) {
+    quotient_limbs = dividend.limbs;
+    remainder_limbs = {divide_by_limb(quotient_limbs, divisor.limbs[0])};
+    trim(remainder_limbs);
+  } else {
+    divide_magnitudes(dividend.limbs, divisor.limbs, quotient_limbs,
+                      remainder_limbs);
+  }
+
+  quotient = BigInt(dividend.negative != divisor.negative,
+                    std::move(quotient_limbs));
+  remainder = BigInt(dividend.negative, std::move(remainder_limbs));
+}
+
+std::strong_ordering operator<=>(const BigInt& lhs, const BigInt& rhs) {
+  if (lhs.negative != rhs.negative) {
+    return lhs.negative ? std::strong_ordering::less
+                        : std::strong_ordering::greater;
+  }
+  std::strong_ordering const magnitude =
+      compare_magnitudes(lhs.limbs, rhs.limbs);
+  return lhs.negative ? 0 <=> magnitude : magnitude;
+}
+
+}  // namespace lisp
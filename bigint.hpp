@@ -0,0 +1,63 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lisp {
+
+// Arbitrary-precision signed integer, for exact results that do not fit in
+// 64 bits. The magnitude is held as base-2^32 limbs, least significant
+// first, with no leading zero limbs; zero has no limbs and is never
+// negative.
+//
+// Multiplication switches from the schoolbook method to Karatsuba once both
+// operands are large, so products of numbers with thousands of digits stay
+// fast.
+class BigInt {
+ public:
+  using Limbs = std::vector<std::uint32_t>;
+
+  BigInt() = default;
+  explicit BigInt(std::int64_t value);
+
+  // Parses an optionally signed decimal integer. Returns nullopt if `text`
+  // is anything else.
+  static std::optional<BigInt> parse(std::string_view text);
+
+  bool is_zero() const { return limbs.empty(); }
+  bool is_negative() const { return negative; }
+
+  // The value as an int64_t, or nullopt if it does not fit.
+  std::optional<std::int64_t> to_int64() const;
+  // The nearest double (infinite if out of range).
+  double to_double() const;
+  // Decimal representation.
+  std::string to_string() const;
+
+  BigInt operator-() const;
+  friend BigInt operator+(const BigInt& lhs, const BigInt& rhs);
+  friend BigInt operator-(const BigInt& lhs, const BigInt& rhs);
+  friend BigInt operator*(const BigInt& lhs, const BigInt& rhs);
+
+  // Truncating division, as for built-in integers: the quotient is rounded
+  // toward zero and the remainder takes the sign of the dividend. Throws
+  // std::domain_error if `divisor` is zero.
+  static void divide(const BigInt& dividend, const BigInt& divisor,
+                     BigInt& quotient, BigInt& remainder);
+
+  friend bool operator==(const BigInt& lhs, const BigInt& rhs) = default;
+  friend std::strong_ordering operator<=>(const BigInt& lhs,
+                                          const BigInt& rhs);
+
+ private:
+  bool negative = false;
+  Limbs limbs;
+
+  BigInt(bool negative, Limbs limbs);
+};
+
+}  // namespace lisp
@@ -0,0 +1,210 @@
+#include "compiler.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "symbol.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+std::shared_ptr<const Chunk> Compiler::compile(const ValuePtr& expr) {
+  Compiler compiler;
+  compiler.compile_expr(expr, true);
+  compiler.emit(OpCode::RETURN);
+  return std::make_shared<const Chunk>(std::move(compiler.chunk));
+}
+
+std::shared_ptr<const Chunk> Compiler::compile_body(
+    const std::vector<ValuePtr>& body) {
+  Compiler compiler;
+  for (std::size_t i = 0; i < body.size(); ++i) {
+    bool const last = i + 1 == body.size();
+    compiler.compile_expr(body[i], last);
+    if (!last) {
+      compiler.emit(OpCode::POP);
+    }
+  }
+  if (body.empty()) {
+    compiler.emit_error("lambda requires at least one body expression");
+  }
+  compiler.emit(OpCode::RETURN);
+  return std::make_shared<const Chunk>(std::move(compiler.chunk));
+}
+
+std::uint32_t Compiler::emit(OpCode op, std::uint32_t a, std::uint32_t b) {
+  chunk.code.push_back(Instruction{op, a, b});
+  return static_cast<std::uint32_t>(chunk.code.size() - 1);
+}
+
+void Compiler::emit_constant(ValuePtr value) {
+  chunk.constants.push_back(std::move(value));
+  emit(OpCode::CONSTANT,
+       static_cast<std::uint32_t>(chunk.constants.size() - 1));
+}
+
+void Compiler::emit_error(const std::string& message) {
+  chunk.errors.push_back(message);
+  emit(OpCode::RAISE, static_cast<std::uint32_t>(chunk.errors.size() - 1));
+}
+
+void Compiler::patch_jump(std::uint32_t jump) {
+  chunk.code[jump].a = static_cast<std::uint32_t>(chunk.code.size());
+}
+
+void Compiler::compile_expr(const ValuePtr& expr, bool tail) {
+  if (!expr) {
+    emit_error("Cannot evaluate null expression");
+    return;
+  }
+
+  switch (expr->type) {
+    case ValueType::NIL:
+    case ValueType::NUMBER:
+    case ValueType::STRING:
+    case ValueType::VECTOR:
+      emit_constant(expr);
+      return;
+    case ValueType::LOCAL_REF: {
+      const LocalRef& ref = expr->as_local_ref();
+      emit(OpCode::LOAD_LOCAL, ref.depth, ref.slot);
+      return;
+    }
+    case ValueType::GLOBAL_REF:
+      chunk.constants.push_back(expr);
+      emit(OpCode::LOAD_GLOBAL,
+           static_cast<std::uint32_t>(chunk.constants.size() - 1));
+      return;
+    case ValueType::SYMBOL:
+      chunk.names.push_back(expr->as_symbol());
+      emit(OpCode::LOAD_NAME,
+           static_cast<std::uint32_t>(chunk.names.size() - 1));
+      return;
+    case ValueType::CONS:
+      break;
+    default:
+      emit_error("Cannot evaluate expression: " + expr->to_string());
+      return;
+  }
+
+  const ValuePtr& first = expr->car();
+  const ValuePtr& args = expr->cdr();
+
+  if (!first) {
+    emit_error("Empty function call");
+    return;
+  }
+
+  if (first->is_symbol()) {
+    Symbol const symbol = first->as_symbol();
+    if (symbol == kQuote) {
+      compile_quote(args);
+      return;
+    }
+    if (symbol == kIf) {
+      compile_if(args, tail);
+      return;
+    }
+    if (symbol == kDefine) {
+      compile_define(args);
+      return;
+    }
+    if (symbol == kLambda) {
+      compile_lambda(args);
+      return;
+    }
+  }
+
+  compile_call(expr, tail);
+}
+
+void Compiler::compile_quote(const ValuePtr& args) {
+  if (!args->is_cons()) {
+    emit_error("quote requires exactly one argument");
+    return;
+  }
+  emit_constant(args->car());
+}
+
+void Compiler::compile_if(const ValuePtr& args, bool tail) {
+  if (!args->is_cons() || !args->cdr()->is_cons()) {
+    emit_error("if requires at least 2 arguments");
+    return;
+  }
+
+  compile_expr(args->car(), false);
+  std::uint32_t const to_else = emit(OpCode::JUMP_IF_NIL);
+
+  compile_expr(args->cdr()->car(), tail);
+  std::uint32_t const to_end = emit(OpCode::JUMP);
+
+  patch_jump(to_else);
+  if (args->cdr()->cdr()->is_cons()) {
+    compile_expr(args->cdr()->cdr()->car(), tail);
+  } else {
+    emit_constant(make_nil());
+  }
+  patch_jump(to_end);
+}
+
+void Compiler::compile_define(const ValuePtr& args) {
+  if (!args->is_cons() || !args->cdr()->is_cons()) {
+    emit_error("define requires exactly 2 arguments");
+    return;
+  }
+
+  const ValuePtr& name = args->car();
+  if (!name->is_symbol()) {
+    emit_error("define requires a symbol as first argument");
+    return;
+  }
+
+  compile_expr(args->cdr()->car(), false);
+  chunk.names.push_back(name->as_symbol());
+  emit(OpCode::DEFINE, static_cast<std::uint32_t>(chunk.names.size() - 1));
+}
+
+void Compiler::compile_lambda(const ValuePtr& args) {
+  if (!args->is_cons() || !args->cdr()->is_cons()) {
+    emit_error("lambda requires at least 2 arguments");
+    return;
+  }
+
+  LambdaTemplate lambda;
+  for (ValuePtr param = args->car(); param && param->is_cons();
+       param = param->cdr()) {
+    if (!param->car()->is_symbol()) {
+      emit_error("lambda parameter must be a symbol");
+      return;
+    }
+    lambda.params.push_back(param->car()->as_symbol());
+  }
+
+  for (ValuePtr body = args->cdr(); body && body->is_cons();
+       body = body->cdr()) {
+    lambda.body.push_back(body->car());
+  }
+
+  lambda.code = compile_body(lambda.body);
+  chunk.lambdas.push_back(std::move(lambda));
+  emit(OpCode::MAKE_LAMBDA,
+       static_cast<std::uint32_t>(chunk.lambdas.size() - 1));
+}
+
+void Compiler::compile_call(const ValuePtr& expr, bool tail) {
+  compile_expr(expr->car(), false);
+
+  std::uint32_t argc = 0;
+  for (ValuePtr arg = expr->cdr(); arg && arg->is_cons(); arg = arg->cdr()) {
+    compile_expr(arg->car(), false);
+    ++argc;
+  }
+
+  emit(tail ? OpCode::TAIL_CALL : OpCode::CALL, argc);
+}
+
+}  // namespace lisp
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "symbol.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+enum class OpCode : std::uint8_t {
+  CONSTANT,     // push constants[a]
+  LOAD_LOCAL,   // push slot b of the frame a levels up
+  LOAD_NAME,    // push the binding of names[a], searching by name
+  LOAD_GLOBAL,  // push the global bound to the GLOBAL_REF constants[a]
+  DEFINE,       // bind names[a] to the top of stack (left in place)
+  POP,          // discard the top of stack
+  JUMP,         // continue at instruction a
+  JUMP_IF_NIL,  // pop; continue at instruction a if it was nil
+  MAKE_LAMBDA,  // push a closure over the current frame for lambdas[a]
+  CALL,         // call the function below the top a values with them
+  TAIL_CALL,    // as CALL, replacing the current frame for lambdas
+  RETURN,       // pop the frame, passing the top of stack to the caller
+  RAISE         // throw EvalError(errors[a])
+};
+
+struct Instruction {
+  OpCode op;
+  std::uint32_t a = 0;
+  std::uint32_t b = 0;
+};
+
+// A lambda expression with its body compiled ahead of time; MAKE_LAMBDA
+// pairs it with the current frame to produce a closure.
+struct LambdaTemplate {
+  std::vector<Symbol> params;
+  std::vector<ValuePtr> body;
+  std::shared_ptr<const Chunk> code;
+};
+
+// A compiled top-level form or lambda body, always ending in RETURN.
+struct Chunk {
+  std::vector<Instruction> code;
+  std::vector<ValuePtr> constants;
+  std::vector<Symbol> names;
+  std::vector<LambdaTemplate> lambdas;
+  std::vector<std::string> errors;
+};
+
+// Lowers parsed (and optionally analyzed) forms to bytecode for the VM.
+//
+// Compilation never fails: a malformed special form compiles to a RAISE of
+// the error the tree-walking Evaluator would report, at the point where it
+// would report it, so both engines behave identically.
+class Compiler {
+ private:
+  Chunk chunk;
+
+  std::uint32_t emit(OpCode op, std::uint32_t a = 0, std::uint32_t b = 0);
+  void emit_constant(ValuePtr value);
+  void emit_error(const std::string& message);
+  void patch_jump(std::uint32_t jump);
+
+  void compile_expr(const ValuePtr& expr, bool tail);
+  void compile_quote(const ValuePtr& args);
+  void compile_if(const ValuePtr& args, bool tail);
+  void compile_define(const ValuePtr& args);
+  void compile_lambda(const ValuePtr& args);
+  void compile_call(const ValuePtr& expr, bool tail);
+
+ public:
+  // Compiles a single top-level expression.
+  static std::shared_ptr<const Chunk> compile(const ValuePtr& expr);
+
+  // Compiles a lambda body: every expression in order, returning the last.
+  static std::shared_ptr<const Chunk> compile_body(
+      const std::vector<ValuePtr>& body);
+};
+
+}  // namespace lisp
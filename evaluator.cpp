@@ -1,35 +1,224 @@
 #include "evaluator.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <compare>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "analyzer.hpp"
+#include "bigint.hpp"
+#include "compiler.hpp"
+#include "f64array.hpp"
+#include "gc.hpp"
+#include "pool.hpp"
+#include "port.hpp"
+#include "shared_string.hpp"
+#include "symbol.hpp"
 #include "value.hpp"
 
 namespace lisp {
 
 namespace {
 
+// Lower bound for Evaluator::gc_threshold.
+constexpr std::size_t kMinGcThreshold = 65536;
+
+enum class SpecialForm : std::uint8_t { NONE, QUOTE, IF, DEFINE, LAMBDA };
+
+// Special forms indexed by the id of the symbol that names them. Their
+// symbols are interned at startup, so the table is short, and any symbol
+// with a larger id names an ordinary variable.
+const std::vector<SpecialForm> kSpecialForms = [] {
+  std::vector<SpecialForm> table;
+  auto const add = [&table](Symbol name, SpecialForm form) {
+    std::uint32_t const id = name.id();
+    if (id >= table.size()) {
+      table.resize(id + 1, SpecialForm::NONE);
+    }
+    table[id] = form;
+  };
+  add(kQuote, SpecialForm::QUOTE);
+  add(kIf, SpecialForm::IF);
+  add(kDefine, SpecialForm::DEFINE);
+  add(kLambda, SpecialForm::LAMBDA);
+  return table;
+}();
+
+SpecialForm special_form(Symbol symbol) {
+  std::uint32_t const id = symbol.id();
+  return id < kSpecialForms.size() ? kSpecialForms[id] : SpecialForm::NONE;
+}
+
+// The result of a predicate: #t, or nil for false.
+const ValuePtr& truth(bool condition) {
+  return condition ? make_true() : make_nil();
+}
+
 bool is_self_evaluating(const ValuePtr& expr) {
-  return expr->is_number() || expr->is_string() || expr->is_nil();
+  return expr->is_number() || expr->is_string() || expr->is_nil() ||
+         expr->is_vector();
 }
 
 //
 // Builtin arithmetic functions
 //
 
-ValuePtr builtin_add(const std::vector<ValuePtr>& args, Environment& /*env*/) {
-  double sum = 0.0;
-  for (const auto& arg : args) {
-    if (!arg->is_number()) {
-      throw EvalError("+ requires numeric arguments");
+// True for an integer NUMBER of either representation.
+bool is_exact(const Value& number) {
+  return number.is_integer() || number.is_bignum();
+}
+
+// An exact integer NUMBER as a BigInt.
+BigInt to_bignum(const Value& number) {
+  return number.is_bignum() ? number.as_bignum()
+                            : BigInt(number.as_integer());
+}
+
+// The arithmetic operators, each with an int64_t step that returns false on
+// overflow, a BigInt step, and a double step. The exact steps of division
+// also return false when the quotient is not an integer.
+struct Add {
+  static constexpr const char* kName = "+";
+  static bool small(std::int64_t lhs, std::int64_t rhs, std::int64_t& result) {
+    return !__builtin_add_overflow(lhs, rhs, &result);
+  }
+  static bool big(const BigInt& lhs, const BigInt& rhs, BigInt& result) {
+    result = lhs + rhs;
+    return true;
+  }
+  static double inexact(double lhs, double rhs) { return lhs + rhs; }
+};
+
+struct Subtract {
+  static constexpr const char* kName = "-";
+  static bool small(std::int64_t lhs, std::int64_t rhs, std::int64_t& result) {
+    return !__builtin_sub_overflow(lhs, rhs, &result);
+  }
+  static bool big(const BigInt& lhs, const BigInt& rhs, BigInt& result) {
+    result = lhs - rhs;
+    return true;
+  }
+  static double inexact(double lhs, double rhs) { return lhs - rhs; }
+};
+
+struct Multiply {
+  static constexpr const char* kName = "*";
+  static bool small(std::int64_t lhs, std::int64_t rhs, std::int64_t& result) {
+    return !__builtin_mul_overflow(lhs, rhs, &result);
+  }
+  static bool big(const BigInt& lhs, const BigInt& rhs, BigInt& result) {
+    result = lhs * rhs;
+    return true;
+  }
+  static double inexact(double lhs, double rhs) { return lhs * rhs; }
+};
+
+struct Divide {
+  static constexpr const char* kName = "/";
+  static bool small(std::int64_t lhs, std::int64_t rhs, std::int64_t& result) {
+    if (rhs == 0) {
+      throw EvalError("Division by zero");
+    }
+    if (rhs == -1) {
+      return !__builtin_sub_overflow(0, lhs, &result);
+    }
+    if (lhs % rhs != 0) {
+      return false;
+    }
+    result = lhs / rhs;
+    return true;
+  }
+  static bool big(const BigInt& lhs, const BigInt& rhs, BigInt& result) {
+    if (rhs.is_zero()) {
+      throw EvalError("Division by zero");
+    }
+    BigInt quotient;
+    BigInt remainder;
+    BigInt::divide(lhs, rhs, quotient, remainder);
+    if (!remainder.is_zero()) {
+      return false;
+    }
+    result = std::move(quotient);
+    return true;
+  }
+  static double inexact(double lhs, double rhs) {
+    if (rhs == 0) {
+      throw EvalError("Division by zero");
     }
-    sum += arg->as_number();
+    return lhs / rhs;
   }
-  return make_number(sum);
+};
+
+// Applies `Op` left to right, starting from `initial` and taking each of
+// `args` in turn. While every operand is an integer the result stays
+// exact: in int64_t arithmetic until a step overflows, then in BigInt. From
+// the first operand that is a double (or division that leaves a
+// remainder), the rest is computed in double.
+template <typename Op>
+ValuePtr fold_numbers(const Value& initial, std::span<const ValuePtr> args) {
+  auto const require_number = [](const Value& value) {
+    if (!value.is_number()) {
+      throw EvalError(std::string(Op::kName) + " requires numeric arguments");
+    }
+  };
+
+  std::size_t i = 0;
+  double inexact = 0.0;
+  if (is_exact(initial)) {
+    std::int64_t small = initial.is_integer() ? initial.as_integer() : 0;
+    std::optional<BigInt> big;
+    if (initial.is_bignum()) {
+      big = initial.as_bignum();
+    }
+    for (; i < args.size(); ++i) {
+      const Value& arg = *args[i];
+      require_number(arg);
+      if (!is_exact(arg)) {
+        break;
+      }
+      std::int64_t next = 0;
+      if (!big && arg.is_integer() && Op::small(small, arg.as_integer(), next)) {
+        small = next;
+        continue;
+      }
+      if (!big) {
+        big = BigInt(small);
+      }
+      BigInt result;
+      if (!Op::big(*big, to_bignum(arg), result)) {
+        break;
+      }
+      big = std::move(result);
+    }
+    if (i == args.size()) {
+      return big ? make_integer(*big) : make_integer(small);
+    }
+    inexact = big ? big->to_double() : static_cast<double>(small);
+  } else {
+    inexact = initial.as_number();
+  }
+
+  for (; i < args.size(); ++i) {
+    require_number(*args[i]);
+    inexact = Op::inexact(inexact, args[i]->as_number());
+  }
+  return make_number(inexact);
+}
+
+ValuePtr builtin_add(const std::vector<ValuePtr>& args, Environment& /*env*/) {
+  return fold_numbers<Add>(*make_integer(0), args);
 }
 
 ValuePtr builtin_subtract(const std::vector<ValuePtr>& args,
@@ -40,15 +229,7 @@ ValuePtr builtin_subtract(const std::vector<ValuePtr>& args,
   if (!args[0]->is_number()) {
     throw EvalError("- requires numeric arguments");
   }
-
-  double result = args[0]->as_number();
-  for (size_t i = 1; i < args.size(); ++i) {
-    if (!args[i]->is_number()) {
-      throw EvalError("- requires numeric arguments");
-    }
-    result -= args[i]->as_number();
-  }
-  return make_number(result);
+  return fold_numbers<Subtract>(*args[0], std::span(args).subspan(1));
 }
 
 ValuePtr builtin_multiply(const std::vector<ValuePtr>& args,
@@ -56,14 +237,7 @@ ValuePtr builtin_multiply(const std::vector<ValuePtr>& args,
   if (args.empty()) {
     throw EvalError("* requires at least one argument");
   }
-  double product = 1.0;
-  for (const auto& arg : args) {
-    if (!arg->is_number()) {
-      throw EvalError("* requires numeric arguments");
-    }
-    product *= arg->as_number();
-  }
-  return make_number(product);
+  return fold_numbers<Multiply>(*make_integer(1), args);
 }
 
 ValuePtr builtin_divide(const std::vector<ValuePtr>& args,
@@ -74,55 +248,35 @@ ValuePtr builtin_divide(const std::vector<ValuePtr>& args,
   if (!args[0]->is_number()) {
     throw EvalError("/ requires numeric arguments");
   }
-
-  double result = args[0]->as_number();
-  for (size_t i = 1; i < args.size(); ++i) {
-    if (!args[i]->is_number()) {
-      throw EvalError("/ requires numeric arguments");
-    }
-    if (args[i]->as_number() == 0) {
-      throw EvalError("Division by zero");
-    }
-    result /= args[i]->as_number();
-  }
-  return make_number(result);
+  return fold_numbers<Divide>(*args[0], std::span(args).subspan(1));
 }
 
 //
 // Builtin list functions
 //
 
-ValuePtr builtin_car(const std::vector<ValuePtr>& args, Environment& /*env*/) {
-  if (args.size() != 1) {
-    throw EvalError("car requires exactly one argument");
-  }
-  if (args[0]->is_nil()) {
+ValuePtr builtin_car(const ValuePtr& list) {
+  if (list->is_nil()) {
     return make_nil();
   }
-  if (!args[0]->is_cons()) {
+  if (!list->is_cons()) {
     throw EvalError("car requires a list argument");
   }
-  return args[0]->car();
+  return list->car();
 }
 
-ValuePtr builtin_cdr(const std::vector<ValuePtr>& args, Environment& /*env*/) {
-  if (args.size() != 1) {
-    throw EvalError("cdr requires exactly one argument");
-  }
-  if (args[0]->is_nil()) {
+ValuePtr builtin_cdr(const ValuePtr& list) {
+  if (list->is_nil()) {
     return make_nil();
   }
-  if (!args[0]->is_cons()) {
+  if (!list->is_cons()) {
     throw EvalError("cdr requires a list argument");
   }
-  return args[0]->cdr();
+  return list->cdr();
 }
 
-ValuePtr builtin_cons(const std::vector<ValuePtr>& args, Environment& /*env*/) {
-  if (args.size() != 2) {
-    throw EvalError("cons requires exactly two arguments");
-  }
-  return make_cons(args[0], args[1]);
+ValuePtr builtin_cons(const ValuePtr& car, const ValuePtr& cdr) {
+  return make_cons(car, cdr);
 }
 
 ValuePtr builtin_list(const std::vector<ValuePtr>& args, Environment& /*env*/) {
@@ -134,191 +288,758 @@ ValuePtr builtin_list(const std::vector<ValuePtr>& args, Environment& /*env*/) {
 }
 
 //
-// Builtin comparison operations
+// Builtin vector functions
 //
 
-ValuePtr builtin_equals(const std::vector<ValuePtr>& args,
+// Returns `index` as a position in a vector of `size` elements, throwing
+// unless it is an exact integer in [0, size).
+std::size_t vector_index(const Value& index, std::size_t size,
+                         const char* name) {
+  if (!index.is_integer()) {
+    throw EvalError(std::string(name) + " requires an integer index");
+  }
+  std::int64_t const position = index.as_integer();
+  if (position < 0 || static_cast<std::uint64_t>(position) >= size) {
+    throw EvalError(std::string(name) + " index out of range: " +
+                    index.to_string());
+  }
+  return static_cast<std::size_t>(position);
+}
+
+ValuePtr builtin_make_vector(const std::vector<ValuePtr>& args,
+                             Environment& /*env*/) {
+  if (args.empty() || args.size() > 2) {
+    throw EvalError("make-vector requires one or two arguments");
+  }
+  if (!args[0]->is_integer() || args[0]->as_integer() < 0) {
+    throw EvalError("make-vector requires a non-negative integer length");
+  }
+  const ValuePtr& fill = args.size() == 2 ? args[1] : make_nil();
+  return make_vector(std::vector<ValuePtr>(
+      static_cast<std::size_t>(args[0]->as_integer()), fill));
+}
+
+ValuePtr builtin_vector(const std::vector<ValuePtr>& args,
                         Environment& /*env*/) {
-  if (args.size() != 2) {
-    throw EvalError("= requires exactly two arguments");
+  return make_vector(args);
+}
+
+ValuePtr builtin_vector_ref(const ValuePtr& vector, const ValuePtr& index) {
+  if (!vector->is_vector()) {
+    throw EvalError("vector-ref requires a vector argument");
+  }
+  const std::vector<ValuePtr>& elements = vector->as_vector();
+  return elements[vector_index(*index, elements.size(), "vector-ref")];
+}
+
+ValuePtr builtin_vector_set(const ValuePtr& vector, const ValuePtr& index,
+                            const ValuePtr& value) {
+  if (!vector->is_vector()) {
+    throw EvalError("vector-set! requires a vector argument");
+  }
+  std::vector<ValuePtr>& elements = vector->as_vector();
+  elements[vector_index(*index, elements.size(), "vector-set!")] = value;
+  return value;
+}
+
+ValuePtr builtin_vector_length(const ValuePtr& vector) {
+  if (!vector->is_vector()) {
+    throw EvalError("vector-length requires a vector argument");
+  }
+  return make_integer(static_cast<std::int64_t>(vector->as_vector().size()));
+}
+
+//
+// Builtin float64 array functions
+//
+
+F64Array& f64array_arg(const ValuePtr& array, const char* name) {
+  if (!array->is_f64array()) {
+    throw EvalError(std::string(name) + " requires an f64array argument");
   }
+  return array->as_f64array();
+}
 
-  const ValuePtr& lhs = args[0];
-  const ValuePtr& rhs = args[1];
+double number_arg(const ValuePtr& number, const char* name) {
+  if (!number->is_number()) {
+    throw EvalError(std::string(name) + " requires numeric arguments");
+  }
+  return number->as_number();
+}
+
+// Returns a new array of `lhs` and `rhs` combined element by element with
+// `kernel`.
+template <auto kernel>
+ValuePtr zip_f64arrays(const ValuePtr& lhs, const ValuePtr& rhs,
+                       const char* name) {
+  const F64Array& left = f64array_arg(lhs, name);
+  const F64Array& right = f64array_arg(rhs, name);
+  if (left.size() != right.size()) {
+    throw EvalError(std::string(name) +
+                    " requires arrays of the same length");
+  }
+  F64Array result(left.size());
+  kernel(left.span(), right.span(), result.span());
+  return make_f64array(std::move(result));
+}
+
+ValuePtr builtin_make_f64array(const std::vector<ValuePtr>& args,
+                               Environment& /*env*/) {
+  if (args.empty() || args.size() > 2) {
+    throw EvalError("make-f64array requires one or two arguments");
+  }
+  if (!args[0]->is_integer() || args[0]->as_integer() < 0) {
+    throw EvalError("make-f64array requires a non-negative integer length");
+  }
+  double const fill =
+      args.size() == 2 ? number_arg(args[1], "make-f64array") : 0.0;
+  return make_f64array(
+      F64Array(static_cast<std::size_t>(args[0]->as_integer()), fill));
+}
+
+ValuePtr builtin_f64array(const std::vector<ValuePtr>& args,
+                          Environment& /*env*/) {
+  F64Array array(args.size());
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    array[i] = number_arg(args[i], "f64array");
+  }
+  return make_f64array(std::move(array));
+}
+
+ValuePtr builtin_list_to_f64array(const ValuePtr& list) {
+  std::size_t length = 0;
+  for (const Value* cell = list.get(); cell->is_cons();
+       cell = cell->cdr().get()) {
+    ++length;
+  }
+  F64Array array(length);
+  const Value* cell = list.get();
+  for (std::size_t i = 0; i < length; ++i, cell = cell->cdr().get()) {
+    array[i] = number_arg(cell->car(), "list->f64array");
+  }
+  return make_f64array(std::move(array));
+}
+
+ValuePtr builtin_f64array_ref(const ValuePtr& array, const ValuePtr& index) {
+  const F64Array& values = f64array_arg(array, "f64array-ref");
+  return make_number(
+      values[vector_index(*index, values.size(), "f64array-ref")]);
+}
+
+ValuePtr builtin_f64array_set(const ValuePtr& array, const ValuePtr& index,
+                              const ValuePtr& value) {
+  F64Array& values = f64array_arg(array, "f64array-set!");
+  values[vector_index(*index, values.size(), "f64array-set!")] =
+      number_arg(value, "f64array-set!");
+  return value;
+}
+
+ValuePtr builtin_f64array_length(const ValuePtr& array) {
+  return make_integer(static_cast<std::int64_t>(
+      f64array_arg(array, "f64array-length").size()));
+}
+
+ValuePtr builtin_f64array_add(const ValuePtr& lhs, const ValuePtr& rhs) {
+  return zip_f64arrays<f64_add>(lhs, rhs, "f64array-add");
+}
+
+ValuePtr builtin_f64array_multiply(const ValuePtr& lhs, const ValuePtr& rhs) {
+  return zip_f64arrays<f64_multiply>(lhs, rhs, "f64array-mul");
+}
+
+ValuePtr builtin_f64array_scale(const ValuePtr& array, const ValuePtr& factor) {
+  const F64Array& values = f64array_arg(array, "f64array-scale");
+  F64Array result(values.size());
+  f64_scale(values.span(), number_arg(factor, "f64array-scale"),
+            result.span());
+  return make_f64array(std::move(result));
+}
+
+ValuePtr builtin_f64array_dot(const ValuePtr& lhs, const ValuePtr& rhs) {
+  const F64Array& left = f64array_arg(lhs, "f64array-dot");
+  const F64Array& right = f64array_arg(rhs, "f64array-dot");
+  if (left.size() != right.size()) {
+    throw EvalError("f64array-dot requires arrays of the same length");
+  }
+  return make_number(f64_dot(left.span(), right.span()));
+}
+
+ValuePtr builtin_f64array_sum(const ValuePtr& array) {
+  return make_number(f64_sum(f64array_arg(array, "f64array-sum").span()));
+}
+
+ValuePtr builtin_f64array_min(const ValuePtr& array) {
+  const F64Array& values = f64array_arg(array, "f64array-min");
+  if (values.size() == 0) {
+    throw EvalError("f64array-min requires a non-empty array");
+  }
+  return make_number(f64_min(values.span()));
+}
+
+ValuePtr builtin_f64array_max(const ValuePtr& array) {
+  const F64Array& values = f64array_arg(array, "f64array-max");
+  if (values.size() == 0) {
+    throw EvalError("f64array-max requires a non-empty array");
+  }
+  return make_number(f64_max(values.span()));
+}
+
+//
+// Builtin hash table functions
+//
+
+HashTable& hash_table_arg(const ValuePtr& table, const char* name) {
+  if (!table->is_hash_table()) {
+    throw EvalError(std::string(name) + " requires a hash table argument");
+  }
+  return table->as_hash_table();
+}
+
+const Value& key_arg(const ValuePtr& key, const char* name) {
+  if (!HashTable::is_hashable(*key)) {
+    throw EvalError(std::string(name) +
+                    " requires a number, string or symbol key");
+  }
+  return *key;
+}
+
+ValuePtr builtin_make_hash_table() { return make_hash_table(); }
+
+ValuePtr builtin_hash_table_get(const std::vector<ValuePtr>& args,
+                                Environment& /*env*/) {
+  if (args.size() < 2 || args.size() > 3) {
+    throw EvalError("hash-table-get requires two or three arguments");
+  }
+  ValuePtr* const value = hash_table_arg(args[0], "hash-table-get")
+                              .find(key_arg(args[1], "hash-table-get"));
+  if (value != nullptr) {
+    return *value;
+  }
+  return args.size() == 3 ? args[2] : make_nil();
+}
+
+ValuePtr builtin_hash_table_put(const ValuePtr& table, const ValuePtr& key,
+                                const ValuePtr& value) {
+  HashTable& entries = hash_table_arg(table, "hash-table-put!");
+  key_arg(key, "hash-table-put!");
+  entries.insert_or_assign(key, value);
+  return value;
+}
+
+ValuePtr builtin_hash_table_delete(const ValuePtr& table,
+                                   const ValuePtr& key) {
+  return truth(hash_table_arg(table, "hash-table-delete!")
+                   .erase(key_arg(key, "hash-table-delete!")));
+}
+
+ValuePtr builtin_hash_table_contains(const ValuePtr& table,
+                                     const ValuePtr& key) {
+  return truth(hash_table_arg(table, "hash-table-contains?")
+                   .find(key_arg(key, "hash-table-contains?")) != nullptr);
+}
+
+ValuePtr builtin_hash_table_count(const ValuePtr& table) {
+  return make_integer(static_cast<std::int64_t>(
+      hash_table_arg(table, "hash-table-count").size()));
+}
+
+ValuePtr builtin_hash_table_keys(const ValuePtr& table) {
+  ValuePtr result = make_nil();
+  hash_table_arg(table, "hash-table-keys")
+      .for_each([&](const ValuePtr& key, const ValuePtr& /*value*/) {
+        result = make_cons(key, result);
+      });
+  return result;
+}
+
+ValuePtr builtin_hash_table_to_alist(const ValuePtr& table) {
+  ValuePtr result = make_nil();
+  hash_table_arg(table, "hash-table->alist")
+      .for_each([&](const ValuePtr& key, const ValuePtr& value) {
+        result = make_cons(make_cons(key, value), result);
+      });
+  return result;
+}
+
+//
+// Builtin string functions
+//
+
+const SharedString& string_arg(const ValuePtr& text, const char* name) {
+  if (!text->is_string()) {
+    throw EvalError(std::string(name) + " requires string arguments");
+  }
+  return text->as_shared_string();
+}
+
+// Returns `index` as a position in a string of `size` characters, throwing
+// unless it is an exact integer in [0, size].
+std::size_t string_index(const Value& index, std::size_t size,
+                         const char* name) {
+  if (!index.is_integer()) {
+    throw EvalError(std::string(name) + " requires integer indices");
+  }
+  std::int64_t const position = index.as_integer();
+  if (position < 0 || static_cast<std::uint64_t>(position) > size) {
+    throw EvalError(std::string(name) + " index out of range: " +
+                    index.to_string());
+  }
+  return static_cast<std::size_t>(position);
+}
 
+ValuePtr builtin_string_append(const std::vector<ValuePtr>& args,
+                               Environment& /*env*/) {
+  SharedString result;
+  for (const ValuePtr& arg : args) {
+    result = SharedString::concat(result, string_arg(arg, "string-append"));
+  }
+  return make_string(std::move(result));
+}
+
+ValuePtr builtin_substring(const std::vector<ValuePtr>& args,
+                           Environment& /*env*/) {
+  if (args.size() < 2 || args.size() > 3) {
+    throw EvalError("substring requires two or three arguments");
+  }
+  const SharedString& text = string_arg(args[0], "substring");
+  std::size_t const start = string_index(*args[1], text.size(), "substring");
+  std::size_t const end = args.size() == 3
+                              ? string_index(*args[2], text.size(), "substring")
+                              : text.size();
+  if (end < start) {
+    throw EvalError("substring end is before its start");
+  }
+  return make_string(text.substr(start, end - start));
+}
+
+ValuePtr builtin_string_length(const ValuePtr& text) {
+  return make_integer(
+      static_cast<std::int64_t>(string_arg(text, "string-length").size()));
+}
+
+//
+// Builtin comparison operations
+//
+
+// Returns <0, 0 or >0 as `lhs` is less than, equal to or greater than `rhs`,
+// both NUMBERs. Two integers are compared exactly.
+int compare_numbers(const Value& lhs, const Value& rhs) {
+  if (lhs.is_integer() && rhs.is_integer()) {
+    return lhs.as_integer() < rhs.as_integer()   ? -1
+           : lhs.as_integer() > rhs.as_integer() ? 1
+                                                 : 0;
+  }
+  if (is_exact(lhs) && is_exact(rhs)) {
+    std::strong_ordering const order = to_bignum(lhs) <=> to_bignum(rhs);
+    return order < 0 ? -1 : order > 0 ? 1 : 0;
+  }
+  double const left = lhs.as_number();
+  double const right = rhs.as_number();
+  return left < right ? -1 : left > right ? 1 : 0;
+}
+
+ValuePtr builtin_equals(const ValuePtr& lhs, const ValuePtr& rhs) {
   if (lhs->type != rhs->type) {
     return make_nil();
   }
 
   if (lhs->is_number()) {
-    return lhs->as_number() == rhs->as_number() ? make_symbol("#t")
-                                                : make_nil();
+    if (is_exact(*lhs) && is_exact(*rhs)) {
+      return truth(compare_numbers(*lhs, *rhs) == 0);
+    }
+    return truth(lhs->as_number() == rhs->as_number());
   }
 
   if (lhs->is_string()) {
-    return lhs->as_string() == rhs->as_string() ? make_symbol("#t")
-                                                : make_nil();
+    return truth(lhs->as_string() == rhs->as_string());
   }
 
   if (lhs->is_symbol()) {
-    return lhs->as_symbol() == rhs->as_symbol() ? make_symbol("#t")
-                                                : make_nil();
+    return truth(lhs->as_symbol() == rhs->as_symbol());
   }
 
   if (lhs->is_nil() && rhs->is_nil()) {
-    return make_symbol("#t");
+    return make_true();
   }
 
   return make_nil();
 }
 
-ValuePtr builtin_less_than(const std::vector<ValuePtr>& args,
-                           Environment& /*env*/) {
-  if (args.size() != 2) {
-    throw EvalError("< requires exactly two arguments");
-  }
-  if (!args[0]->is_number() || !args[1]->is_number()) {
+ValuePtr builtin_less_than(const ValuePtr& lhs, const ValuePtr& rhs) {
+  if (!lhs->is_number() || !rhs->is_number()) {
     throw EvalError("< requires numeric arguments");
   }
-  return args[0]->as_number() < args[1]->as_number() ? make_symbol("#t")
-                                                     : make_nil();
+  return truth(compare_numbers(*lhs, *rhs) < 0);
 }
 
-ValuePtr builtin_greater_than(const std::vector<ValuePtr>& args,
-                              Environment& /*env*/) {
-  if (args.size() != 2) {
-    throw EvalError("> requires exactly two arguments");
-  }
-  if (!args[0]->is_number() || !args[1]->is_number()) {
+ValuePtr builtin_greater_than(const ValuePtr& lhs, const ValuePtr& rhs) {
+  if (!lhs->is_number() || !rhs->is_number()) {
     throw EvalError("> requires numeric arguments");
   }
-  return args[0]->as_number() > args[1]->as_number() ? make_symbol("#t")
-                                                     : make_nil();
+  return truth(compare_numbers(*lhs, *rhs) > 0);
 }
 
 //
 // Builtin type predicates
 //
 
-ValuePtr builtin_is_null(const std::vector<ValuePtr>& args,
-                         Environment& /*env*/) {
-  if (args.size() != 1) {
-    throw EvalError("null? requires exactly one argument");
-  }
-  return args[0]->is_nil() ? make_symbol("#t") : make_nil();
+ValuePtr builtin_is_null(const ValuePtr& value) {
+  return truth(value->is_nil());
 }
 
-ValuePtr builtin_is_number(const std::vector<ValuePtr>& args,
-                           Environment& /*env*/) {
-  if (args.size() != 1) {
-    throw EvalError("number? requires exactly one argument");
-  }
-  return args[0]->is_number() ? make_symbol("#t") : make_nil();
+ValuePtr builtin_is_number(const ValuePtr& value) {
+  return truth(value->is_number());
 }
 
-ValuePtr builtin_is_string(const std::vector<ValuePtr>& args,
-                           Environment& /*env*/) {
-  if (args.size() != 1) {
-    throw EvalError("string? requires exactly one argument");
-  }
-  return args[0]->is_string() ? make_symbol("#t") : make_nil();
+ValuePtr builtin_is_string(const ValuePtr& value) {
+  return truth(value->is_string());
 }
 
-ValuePtr builtin_is_symbol(const std::vector<ValuePtr>& args,
-                           Environment& /*env*/) {
-  if (args.size() != 1) {
-    throw EvalError("symbol? requires exactly one argument");
-  }
-  return args[0]->is_symbol() ? make_symbol("#t") : make_nil();
+ValuePtr builtin_is_symbol(const ValuePtr& value) {
+  return truth(value->is_symbol());
 }
 
-ValuePtr builtin_is_cons(const std::vector<ValuePtr>& args,
-                         Environment& /*env*/) {
-  if (args.size() != 1) {
-    throw EvalError("cons? requires exactly one argument");
-  }
-  return args[0]->is_cons() ? make_symbol("#t") : make_nil();
+ValuePtr builtin_is_cons(const ValuePtr& value) {
+  return truth(value->is_cons());
+}
+
+ValuePtr builtin_is_vector(const ValuePtr& value) {
+  return truth(value->is_vector());
+}
+
+ValuePtr builtin_is_f64array(const ValuePtr& value) {
+  return truth(value->is_f64array());
+}
+
+ValuePtr builtin_is_hash_table(const ValuePtr& value) {
+  return truth(value->is_hash_table());
+}
+
+ValuePtr builtin_is_port(const ValuePtr& value) {
+  return truth(value->is_port());
 }
 
 //
 // Builtin I/O functions
 //
 
-ValuePtr builtin_print(const std::vector<ValuePtr>& args,
-                       Environment& /*env*/) {
-  if (args.size() != 1) {
-    throw EvalError("print requires exactly one argument");
+ValuePtr builtin_print(const ValuePtr& value) {
+  print_value(*value, std::cout);
+  std::cout << '\n';
+  return value;
+}
+
+ValuePtr builtin_display(const ValuePtr& value) {
+  print_value(*value, std::cout);
+  return value;
+}
+
+ValuePtr builtin_newline() {
+  std::cout << '\n';
+  return make_nil();
+}
+
+ValuePtr builtin_flush() {
+  std::cout.flush();
+  return make_nil();
+}
+
+// Returns the open port `port`, throwing unless it reads (or writes, when
+// `input` is false).
+Port& port_arg(const ValuePtr& port, bool input, const char* name) {
+  if (!port->is_port()) {
+    throw EvalError(std::string(name) + " requires a port argument");
   }
-  std::cout << args[0]->to_string() << '\n';
-  return args[0];
+  Port& open_port = port->as_port();
+  if (!open_port.is_open()) {
+    throw EvalError(std::string(name) + " cannot use a closed port");
+  }
+  if (open_port.is_input() != input) {
+    throw EvalError(std::string(name) + " requires an " +
+                    (input ? "input" : "output") + " port");
+  }
+  return open_port;
 }
 
-ValuePtr builtin_display(const std::vector<ValuePtr>& args,
-                         Environment& /*env*/) {
-  if (args.size() != 1) {
-    throw EvalError("display requires exactly one argument");
+// The stream named by an optional trailing port argument at `args[index]`,
+// or standard input or output when it is absent.
+std::istream& input_arg(const std::vector<ValuePtr>& args, std::size_t index,
+                        const char* name) {
+  if (args.size() <= index) {
+    return std::cin;
   }
-  std::cout << args[0]->to_string();
-  return args[0];
+  return port_arg(args[index], true, name).stream();
 }
 
-ValuePtr builtin_newline(const std::vector<ValuePtr>& args,
-                         Environment& /*env*/) {
-  if (!args.empty()) {
-    throw EvalError("newline takes no arguments");
+std::ostream& output_arg(const std::vector<ValuePtr>& args,
+                         std::size_t index, const char* name) {
+  if (args.size() <= index) {
+    return std::cout;
   }
-  std::cout << '\n';
-  return make_nil();
+  return port_arg(args[index], false, name).stream();
+}
+
+ValuePtr open_port(const ValuePtr& path, Port::Direction direction,
+                   const char* name) {
+  std::unique_ptr<Port> port =
+      Port::open(std::string(string_arg(path, name).view()), direction);
+  if (!port) {
+    throw EvalError("Could not open file '" + std::string(path->as_string()) +
+                    "': " + std::strerror(errno));
+  }
+  return make_port(std::move(port));
+}
+
+ValuePtr builtin_open_input_file(const ValuePtr& path) {
+  return open_port(path, Port::Direction::INPUT, "open-input-file");
+}
+
+ValuePtr builtin_open_output_file(const ValuePtr& path) {
+  return open_port(path, Port::Direction::OUTPUT, "open-output-file");
 }
 
 ValuePtr builtin_read_line(const std::vector<ValuePtr>& args,
                            Environment& /*env*/) {
-  if (!args.empty()) {
-    throw EvalError("read-line takes no arguments");
+  if (args.size() > 1) {
+    throw EvalError("read-line takes at most one argument");
   }
   std::string line;
-  if (std::getline(std::cin, line)) {
-    return make_string(line);
+  if (std::getline(input_arg(args, 0, "read-line"), line)) {
+    return make_string(std::move(line));
+  }
+  return make_nil();
+}
+
+ValuePtr builtin_read_char(const std::vector<ValuePtr>& args,
+                           Environment& /*env*/) {
+  if (args.size() > 1) {
+    throw EvalError("read-char takes at most one argument");
+  }
+  char c = 0;
+  if (input_arg(args, 0, "read-char").get(c)) {
+    return make_string(std::string(1, c));
+  }
+  return make_nil();
+}
+
+ValuePtr builtin_write_string(const std::vector<ValuePtr>& args,
+                              Environment& /*env*/) {
+  if (args.empty() || args.size() > 2) {
+    throw EvalError("write-string requires one or two arguments");
+  }
+  std::string_view const text = string_arg(args[0], "write-string").view();
+  std::ostream& out = output_arg(args, 1, "write-string");
+  if (!out.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+    throw EvalError("write-string could not write to its port");
+  }
+  return args[0];
+}
+
+ValuePtr builtin_close_port(const ValuePtr& port) {
+  if (!port->is_port()) {
+    throw EvalError("close-port requires a port argument");
+  }
+  if (!port->as_port().close()) {
+    throw EvalError(std::string("close-port failed: ") +
+                    std::strerror(errno));
   }
   return make_nil();
 }
 
+// Pops an argument stack back to its size at construction.
+class ArgStackMark {
+ private:
+  std::vector<ValuePtr>& stack;
+  std::size_t saved_size;
+
+ public:
+  explicit ArgStackMark(std::vector<ValuePtr>& stack)
+      : stack(stack), saved_size(stack.size()) {}
+  ~ArgStackMark() { stack.resize(saved_size); }
+  ArgStackMark(const ArgStackMark&) = delete;
+  ArgStackMark& operator=(const ArgStackMark&) = delete;
+
+  std::size_t base() const { return saved_size; }
+};
+
 }  // namespace
 
-Evaluator::Evaluator() {
+ValuePtr call_builtin(const BuiltinFunction& builtin, std::span<ValuePtr> args,
+                      std::vector<ValuePtr>& buffer, Environment& env) {
+  // Take the buffer while the builtin runs, so that a nested call made from
+  // inside it gets a fresh one instead of clobbering these arguments.
+  std::vector<ValuePtr> arg_values = std::move(buffer);
+  arg_values.assign(std::make_move_iterator(args.begin()),
+                    std::make_move_iterator(args.end()));
+  ValuePtr result = builtin(arg_values, env);
+  arg_values.clear();
+  buffer = std::move(arg_values);
+  return result;
+}
+
+Evaluator::Evaluator(Engine engine)
+    : engine(engine), vm(*this), gc_threshold(kMinGcThreshold) {
   global_env = std::make_shared<Environment>();
   setup_builtins();
 }
 
+Evaluator::~Evaluator() {
+  // Top-level closures refer back to the global environment that binds
+  // them; reclaim the cycle unless someone else still holds it.
+  global_env.reset();
+  collect_cycles();
+}
+
 ValuePtr Evaluator::eval(const ValuePtr& expr, Environment& env) {
-  if (!expr) {
-    throw EvalError("Cannot evaluate null expression");
-  }
+  // Expressions in tail position (the chosen branch of an if, the last
+  // expression of a lambda body) are evaluated by another trip around this
+  // loop rather than a recursive call, so tail calls run in constant C++
+  // stack space.
+  //
+  // The expression being evaluated is borrowed rather than reference
+  // counted: it is part of `expr` or, after a tail call, of the body of the
+  // lambda that `frame` was created for, and either keeps it alive.
+  const ValuePtr* current = &expr;
+  Environment* current_env = &env;
+  std::shared_ptr<Environment> frame;  // Owns current_env after a tail call.
+
+  while (true) {
+    if (!*current) {
+      throw EvalError("Cannot evaluate null expression");
+    }
 
-  // Self-evaluating expressions
-  if (is_self_evaluating(expr)) {
-    return expr;
-  }
+    // Self-evaluating expressions
+    if (is_self_evaluating(*current)) {
+      return *current;
+    }
 
-  // Symbols - variable lookup
-  if (expr->is_symbol()) {
-    ValuePtr value = env.lookup(expr->as_symbol());
-    if (!value) {
-      throw EvalError("Unbound symbol: " + expr->as_symbol());
+    // Resolved lambda parameters - indexed load
+    if ((*current)->is_local_ref()) {
+      const LocalRef& ref = (*current)->as_local_ref();
+      return current_env->lookup(ref.depth, ref.slot);
     }
-    return value;
-  }
 
-  // Lists - function calls or special forms
-  if (expr->is_cons()) {
-    return eval_list(expr, env);
-  }
+    // Resolved globals - cached binding cell
+    if ((*current)->is_global_ref()) {
+      const GlobalRef& ref = (*current)->as_global_ref();
+      const ValuePtr* const cell = global_env->global_cell(ref);
+      if (cell == nullptr) {
+        throw EvalError("Unbound symbol: " + ref.name.name());
+      }
+      return *cell;
+    }
+
+    // Symbols - variable lookup
+    if ((*current)->is_symbol()) {
+      ValuePtr value = current_env->lookup((*current)->as_symbol());
+      if (!value) {
+        throw EvalError("Unbound symbol: " + (*current)->as_symbol().name());
+      }
+      return value;
+    }
+
+    if (!(*current)->is_cons()) {
+      throw EvalError("Cannot evaluate expression: " + (*current)->to_string());
+    }
+
+    // Lists - function calls or special forms
+    const ValuePtr& first = (*current)->car();
+    const ValuePtr& args = (*current)->cdr();
+
+    if (!first) {
+      throw EvalError("Empty function call");
+    }
+
+    // Special forms
+    if (first->is_symbol()) {
+      switch (special_form(first->as_symbol())) {
+        case SpecialForm::QUOTE:
+          return do_quote(args);
+        case SpecialForm::IF:
+          current = &do_if(args, *current_env);
+          continue;
+        case SpecialForm::DEFINE:
+          return do_define(args, *current_env);
+        case SpecialForm::LAMBDA:
+          return do_lambda(args, *current_env);
+        case SpecialForm::NONE:
+          break;
+      }
+    }
+
+    // Function call
+    ValuePtr func = eval(first, *current_env);
+    if (func->is_native()) {
+      return apply_native(func->as_native(), args, *current_env);
+    }
+
+    // Arguments are evaluated onto arg_stack, and popped again however the
+    // call ends.
+    ArgStackMark const mark(arg_stack);
+    std::size_t const argc = push_args(args, *current_env);
+    std::span<ValuePtr> const arg_values(arg_stack.data() + mark.base(), argc);
+
+    if (func->is_builtin()) {
+      return call_builtin(func->as_builtin(), arg_values, builtin_args,
+                          *current_env);
+    }
+
+    if (!func->is_lambda()) {
+      throw EvalError("Cannot call non-function: " + func->to_string());
+    }
+
+    const Lambda& lambda = func->as_lambda();
+
+    if (arg_values.size() != lambda.params.size()) {
+      throw EvalError("Lambda expects " + std::to_string(lambda.params.size()) +
+                      " arguments, got " + std::to_string(arg_values.size()));
+    }
+    if (lambda.body.empty()) {
+      throw EvalError("lambda requires at least one body expression");
+    }
 
-  throw EvalError("Cannot evaluate expression: " + expr->to_string());
+    safe_point(*current_env);
+    // The frame takes over `func`, which keeps `lambda` alive.
+    frame = std::allocate_shared<Environment>(
+        PoolAllocator<Environment>(), lambda.closure, std::move(func),
+        arg_values);
+    current_env = frame.get();
+
+    // Evaluate all but the last body expression for effect; the last one is
+    // the result and is evaluated in tail position.
+    for (size_t i = 0; i + 1 < lambda.body.size(); ++i) {
+      eval(lambda.body[i], *current_env);
+    }
+    current = &lambda.body.back();
+  }
 }
 
 ValuePtr Evaluator::eval(const ValuePtr& expr) {
-  return eval(expr, *global_env);
+  Analyzer analyzer;
+  ValuePtr const analyzed = analyzer.analyze(expr);
+  ValuePtr result = engine == Engine::BYTECODE
+                        ? vm.run(Compiler::compile(analyzed), *global_env)
+                        : eval(analyzed, *global_env);
+  safe_point(*global_env);
+  return result;
+}
+
+void Evaluator::collect_garbage(Environment& env) {
+  // Frames of enclosing tree-walker calls are owned by shared_ptrs on the C++
+  // stack, which the collector counts as external references.
+  std::vector<ValuePtr> value_roots = arg_stack;
+  std::vector<Environment*> env_roots = {&env, global_env.get()};
+  vm.append_roots(value_roots, env_roots);
+
+  // Old frames are scanned once their number has doubled since the last
+  // full collection, which keeps the cost proportional to the garbage
+  // produced.
+  if (Environment::live_count() < gc_threshold) {
+    collect_young_cycles(value_roots, env_roots);
+    return;
+  }
+  collect_cycles(value_roots, env_roots);
+  gc_threshold = std::max(kMinGcThreshold, 2 * Environment::live_count());
 }
 
 ValuePtr Evaluator::do_quote(const ValuePtr& quote_args) {
@@ -328,20 +1049,18 @@ ValuePtr Evaluator::do_quote(const ValuePtr& quote_args) {
   return quote_args->car();
 }
 
-ValuePtr Evaluator::do_if(const ValuePtr& if_args, Environment& env) {
+const ValuePtr& Evaluator::do_if(const ValuePtr& if_args, Environment& env) {
   if (!if_args->is_cons() || !if_args->cdr()->is_cons()) {
     throw EvalError("if requires at least 2 arguments");
   }
 
   ValuePtr const condition = eval(if_args->car(), env);
   if (!condition->is_nil()) {
-    return eval(if_args->cdr()->car(), env);
+    return if_args->cdr()->car();
   }
 
-  ValuePtr const else_branch = if_args->cdr()->cdr()->is_cons()
-                                   ? if_args->cdr()->cdr()->car()
-                                   : make_nil();
-  return eval(else_branch, env);
+  return if_args->cdr()->cdr()->is_cons() ? if_args->cdr()->cdr()->car()
+                                          : make_nil();
 }
 
 ValuePtr Evaluator::do_define(const ValuePtr& define_args, Environment& env) {
@@ -369,7 +1088,7 @@ ValuePtr Evaluator::do_lambda(const ValuePtr& lambda_args, Environment& env) {
   ValuePtr const params_list = lambda_args->car();
   ValuePtr body_list = lambda_args->cdr();
 
-  std::vector<std::string> params;
+  std::vector<Symbol> params;
   ValuePtr current = params_list;
   while (current && current->is_cons()) {
     ValuePtr const param = current->car();
@@ -392,90 +1111,49 @@ ValuePtr Evaluator::do_lambda(const ValuePtr& lambda_args, Environment& env) {
     throw EvalError("lambda requires at least one body expression");
   }
 
-  return make_lambda(params, body,
-                     std::make_shared<Environment>(env.shared_from_this()));
+  return make_lambda(params, body, env.shared_from_this());
 }
 
-ValuePtr Evaluator::eval_list(const ValuePtr& expr, Environment& env) {
-  if (!expr->is_cons()) {
-    throw EvalError("Expected list for function call");
-  }
-
-  ValuePtr const first = expr->car();
-  ValuePtr const args = expr->cdr();
-
-  if (!first) {
-    throw EvalError("Empty function call");
+std::size_t Evaluator::push_args(const ValuePtr& args, Environment& env) {
+  std::size_t count = 0;
+  for (const Value* arg = args.get(); arg->is_cons(); arg = arg->cdr().get()) {
+    // Evaluate before pushing: the evaluation may grow arg_stack itself.
+    ValuePtr value = eval(arg->car(), env);
+    arg_stack.push_back(std::move(value));
+    ++count;
   }
+  return count;
+}
 
-  // Special forms
-  if (first->is_symbol()) {
-    const std::string& symbol = first->as_symbol();
-
-    if (symbol == "quote") {
-      return do_quote(args);
-    }
-
-    if (symbol == "if") {
-      return do_if(args, env);
-    }
-
-    if (symbol == "define") {
-      return do_define(args, env);
-    }
-
-    if (symbol == "lambda") {
-      return do_lambda(args, env);
+ValuePtr Evaluator::apply_native(const NativeBuiltin& native,
+                                 const ValuePtr& args, Environment& env) {
+  std::array<ValuePtr, NativeBuiltin::kMaxArity> arg_values;
+  std::size_t count = 0;
+
+  // Every argument is evaluated, even surplus ones, so side effects and
+  // errors happen as they would for any other call.
+  for (const Value* arg = args.get(); arg->is_cons(); arg = arg->cdr().get()) {
+    ValuePtr value = eval(arg->car(), env);
+    if (count < arg_values.size()) {
+      arg_values[count] = std::move(value);
     }
+    ++count;
   }
 
-  // Function call
-  ValuePtr const func = eval(first, env);
-  std::vector<ValuePtr> arg_values = eval_args(args, env);
-
-  if (func->is_builtin()) {
-    return func->as_builtin()(arg_values, env);
-  }
-
-  if (func->is_lambda()) {
-    const Lambda& lambda = func->as_lambda();
-
-    if (arg_values.size() != lambda.params.size()) {
-      throw EvalError("Lambda expects " + std::to_string(lambda.params.size()) +
-                      " arguments, got " + std::to_string(arg_values.size()));
-    }
-
-    auto new_env = lambda.closure->extend();
-    for (size_t i = 0; i < lambda.params.size(); ++i) {
-      new_env->define(lambda.params[i], arg_values[i]);
-    }
-
-    // Evaluate all body expressions sequentially, return result of last one
-    ValuePtr result;
-    for (const auto& expr : lambda.body) {
-      result = eval(expr, *new_env);
-    }
-    return result;
+  if (count != native.arity()) {
+    throw EvalError(native.arity_error());
   }
-
-  throw EvalError("Cannot call non-function: " + func->to_string());
+  return native.call(arg_values.data());
 }
 
-std::vector<ValuePtr> Evaluator::eval_args(ValuePtr args, Environment& env) {
-  std::vector<ValuePtr> result;
-  ValuePtr current = std::move(args);
-
-  while (current && current->is_cons()) {
-    result.push_back(eval(current->car(), env));
-    current = current->cdr();
-  }
-  return result;
+void Evaluator::define_native(std::string_view name, NativeFunction function) {
+  global_env->define(name, make_native(name, function));
 }
 
 void Evaluator::setup_builtins() {
   // Boolean constants
-  global_env->define("#t", make_symbol("#t"));
-  global_env->define("#f", make_symbol("#f"));
+  global_env->define("#t", make_true());
+  global_env->define("#f", make_false());
 
   // Arithmetic operations
   global_env->define("+", make_builtin(builtin_add));
@@ -484,28 +1162,77 @@ void Evaluator::setup_builtins() {
   global_env->define("/", make_builtin(builtin_divide));
 
   // List operations
-  global_env->define("car", make_builtin(builtin_car));
-  global_env->define("cdr", make_builtin(builtin_cdr));
-  global_env->define("cons", make_builtin(builtin_cons));
+  define_native("car", builtin_car);
+  define_native("cdr", builtin_cdr);
+  define_native("cons", builtin_cons);
   global_env->define("list", make_builtin(builtin_list));
 
+  // Vector operations
+  global_env->define("make-vector", make_builtin(builtin_make_vector));
+  global_env->define("vector", make_builtin(builtin_vector));
+  define_native("vector-ref", builtin_vector_ref);
+  define_native("vector-set!", builtin_vector_set);
+  define_native("vector-length", builtin_vector_length);
+
+  // Float64 array operations
+  global_env->define("make-f64array", make_builtin(builtin_make_f64array));
+  global_env->define("f64array", make_builtin(builtin_f64array));
+  define_native("list->f64array", builtin_list_to_f64array);
+  define_native("f64array-ref", builtin_f64array_ref);
+  define_native("f64array-set!", builtin_f64array_set);
+  define_native("f64array-length", builtin_f64array_length);
+  define_native("f64array-add", builtin_f64array_add);
+  define_native("f64array-mul", builtin_f64array_multiply);
+  define_native("f64array-scale", builtin_f64array_scale);
+  define_native("f64array-dot", builtin_f64array_dot);
+  define_native("f64array-sum", builtin_f64array_sum);
+  define_native("f64array-min", builtin_f64array_min);
+  define_native("f64array-max", builtin_f64array_max);
+
+  // Hash table operations
+  define_native("make-hash-table", builtin_make_hash_table);
+  global_env->define("hash-table-get", make_builtin(builtin_hash_table_get));
+  define_native("hash-table-put!", builtin_hash_table_put);
+  define_native("hash-table-delete!", builtin_hash_table_delete);
+  define_native("hash-table-contains?", builtin_hash_table_contains);
+  define_native("hash-table-count", builtin_hash_table_count);
+  define_native("hash-table-keys", builtin_hash_table_keys);
+  define_native("hash-table->alist", builtin_hash_table_to_alist);
+
+  // String operations
+  global_env->define("string-append", make_builtin(builtin_string_append));
+  global_env->define("substring", make_builtin(builtin_substring));
+  define_native("string-length", builtin_string_length);
+
   // Comparison operations
-  global_env->define("=", make_builtin(builtin_equals));
-  global_env->define("<", make_builtin(builtin_less_than));
-  global_env->define(">", make_builtin(builtin_greater_than));
+  define_native("=", builtin_equals);
+  define_native("<", builtin_less_than);
+  define_native(">", builtin_greater_than);
 
   // Type predicates
-  global_env->define("null?", make_builtin(builtin_is_null));
-  global_env->define("number?", make_builtin(builtin_is_number));
-  global_env->define("string?", make_builtin(builtin_is_string));
-  global_env->define("symbol?", make_builtin(builtin_is_symbol));
-  global_env->define("cons?", make_builtin(builtin_is_cons));
+  define_native("null?", builtin_is_null);
+  define_native("number?", builtin_is_number);
+  define_native("string?", builtin_is_string);
+  define_native("symbol?", builtin_is_symbol);
+  define_native("cons?", builtin_is_cons);
+  define_native("vector?", builtin_is_vector);
+  define_native("f64array?", builtin_is_f64array);
+  define_native("hash-table?", builtin_is_hash_table);
+  define_native("port?", builtin_is_port);
 
   // I/O operations
-  global_env->define("print", make_builtin(builtin_print));
-  global_env->define("display", make_builtin(builtin_display));
-  global_env->define("newline", make_builtin(builtin_newline));
+  define_native("print", builtin_print);
+  define_native("display", builtin_display);
+  define_native("newline", builtin_newline);
+  define_native("flush", builtin_flush);
   global_env->define("read-line", make_builtin(builtin_read_line));
+  global_env->define("read-char", make_builtin(builtin_read_char));
+
+  // Port operations
+  define_native("open-input-file", builtin_open_input_file);
+  define_native("open-output-file", builtin_open_output_file);
+  global_env->define("write-string", make_builtin(builtin_write_string));
+  define_native("close-port", builtin_close_port);
 }
 
 }  // namespace lisp
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "value.hpp"
+#include "vm.hpp"
 
 namespace lisp {
 
@@ -13,21 +20,76 @@ class EvalError : public std::runtime_error {
       : std::runtime_error(message) {}
 };
 
+// Calls a variadic builtin with `args` (which are moved from), reusing the
+// storage of `buffer` for the argument vector it takes.
+ValuePtr call_builtin(const BuiltinFunction& builtin, std::span<ValuePtr> args,
+                      std::vector<ValuePtr>& buffer, Environment& env);
+
 class Evaluator {
+ public:
+  // How top-level forms passed to eval(expr) are executed. Both engines share
+  // the global environment and builtins and produce identical results.
+  enum class Engine : std::uint8_t {
+    TREE_WALKER,  // Evaluate the parsed form directly.
+    BYTECODE      // Compile the form with Compiler and run it on the VM.
+  };
+
  private:
+  Engine engine;
+  VM vm;
   std::shared_ptr<Environment> global_env;
+  // Number of new Environments at which a safe point collects the cycles
+  // among them.
+  static constexpr std::size_t kYoungGcThreshold = 16384;
+  // Live Environment count at which a collection scans old Environments
+  // too.
+  std::size_t gc_threshold;
+  // Evaluated arguments of the calls in progress, innermost last. Lambda
+  // frames take their parameters from here, so calls do not allocate an
+  // argument vector.
+  std::vector<ValuePtr> arg_stack;
+  // Reused storage for the argument vector of variadic builtins.
+  std::vector<ValuePtr> builtin_args;
+
+  friend class VM;
+
+  // Called by both engines just before a lambda frame is created in `env`.
+  // Once kYoungGcThreshold frames have been created, collects cycles with
+  // arg_stack, the VM's stacks and `env` as roots, so a single long-running
+  // form does not accumulate garbage frames until it returns.
+  void safe_point(Environment& env) {
+    if (Environment::young_count() >= kYoungGcThreshold) {
+      collect_garbage(env);
+    }
+  }
+  void collect_garbage(Environment& env);
 
   void setup_builtins();
+  // Binds `name` to a fixed-arity builtin.
+  void define_native(std::string_view name, NativeFunction function);
   static ValuePtr do_quote(const ValuePtr& quote_args);
-  ValuePtr do_if(const ValuePtr& if_args, Environment& env);
+  // Evaluates the condition and returns the branch expression, which the
+  // caller evaluates in tail position.
+  const ValuePtr& do_if(const ValuePtr& if_args, Environment& env);
   ValuePtr do_define(const ValuePtr& define_args, Environment& env);
   static ValuePtr do_lambda(const ValuePtr& lambda_args, Environment& env);
-  ValuePtr eval_list(const ValuePtr& expr, Environment& env);
-  std::vector<ValuePtr> eval_args(ValuePtr args, Environment& env);
+  // Evaluates the argument expressions `args` onto arg_stack and returns
+  // how many there were.
+  std::size_t push_args(const ValuePtr& args, Environment& env);
+  // Evaluates the argument expressions `args` into a fixed array and calls
+  // `native` with them.
+  ValuePtr apply_native(const NativeBuiltin& native, const ValuePtr& args,
+                        Environment& env);
 
  public:
-  Evaluator();
+  explicit Evaluator(Engine engine = Engine::TREE_WALKER);
+  ~Evaluator();
+  Evaluator(const Evaluator&) = delete;
+  Evaluator& operator=(const Evaluator&) = delete;
   ValuePtr eval(const ValuePtr& expr, Environment& env);
+  // Evaluates a top-level form in the global environment, resolving its
+  // lambda parameter references with Analyzer first, using the selected
+  // engine.
   ValuePtr eval(const ValuePtr& expr);
   std::shared_ptr<Environment> get_global_env() { return global_env; }
 };
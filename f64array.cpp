@@ -0,0 +1,150 @@
+#include "f64array.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <span>
+
+namespace lisp {
+
+namespace {
+
+// Two doubles processed as one unit: a 128-bit vector, the width every
+// x86-64 (SSE2) and AArch64 (NEON) target has, so GCC and Clang lower
+// operations on it to single vector instructions without tying the code to
+// one instruction set or changing the calling convention.
+constexpr std::size_t kLanes = 2;
+using Lanes = double __attribute__((vector_size(kLanes * sizeof(double))));
+
+// Reductions keep this many vectors of partial results in flight, which
+// hides the latency of each floating-point step.
+constexpr std::size_t kAccumulators = 4;
+constexpr std::size_t kBlock = kLanes * kAccumulators;
+
+Lanes load(const double* source) {
+  Lanes lanes;
+  std::memcpy(&lanes, source, sizeof(lanes));
+  return lanes;
+}
+
+void store(double* destination, Lanes lanes) {
+  std::memcpy(destination, &lanes, sizeof(lanes));
+}
+
+Lanes broadcast(double value) { return Lanes{value, value}; }
+
+// Applies `op` to corresponding elements of `lhs` and `rhs`, a vector of
+// lanes at a time with a scalar loop for the tail.
+template <typename Op>
+void zip(std::span<const double> lhs, std::span<const double> rhs,
+         std::span<double> out, Op op) {
+  std::size_t const size = out.size();
+  std::size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    store(&out[i], op(load(&lhs[i]), load(&rhs[i])));
+  }
+  for (; i < size; ++i) {
+    out[i] = op(Lanes{lhs[i]}, Lanes{rhs[i]})[0];
+  }
+}
+
+// Folds `values` with `op`, starting from `identity`, and returns the two
+// lanes of the result for the caller to combine.
+template <typename Op>
+Lanes reduce(std::span<const double> values, double identity, Op op) {
+  std::array<Lanes, kAccumulators> acc;
+  acc.fill(broadcast(identity));
+  std::size_t const size = values.size();
+  std::size_t i = 0;
+  for (; i + kBlock <= size; i += kBlock) {
+    for (std::size_t j = 0; j < kAccumulators; ++j) {
+      acc[j] = op(acc[j], load(&values[i + j * kLanes]));
+    }
+  }
+  Lanes result = op(op(acc[0], acc[1]), op(acc[2], acc[3]));
+  for (; i < size; ++i) {
+    result = op(result, Lanes{values[i], identity});
+  }
+  return result;
+}
+
+// Lane-wise minimum and maximum. A NaN in `next` compares false, so the
+// accumulator is kept.
+Lanes lane_min(Lanes acc, Lanes next) { return next < acc ? next : acc; }
+Lanes lane_max(Lanes acc, Lanes next) { return next > acc ? next : acc; }
+
+}  // namespace
+
+F64Array::F64Array(std::size_t size, double fill)
+    : values(size == 0 ? nullptr
+                       : static_cast<double*>(::operator new[](
+                             size * sizeof(double),
+                             std::align_val_t(kAlignment)))),
+      count(size) {
+  std::fill_n(values.get(), size, fill);
+}
+
+void f64_add(std::span<const double> lhs, std::span<const double> rhs,
+             std::span<double> out) {
+  zip(lhs, rhs, out, [](Lanes a, Lanes b) { return a + b; });
+}
+
+void f64_multiply(std::span<const double> lhs, std::span<const double> rhs,
+                  std::span<double> out) {
+  zip(lhs, rhs, out, [](Lanes a, Lanes b) { return a * b; });
+}
+
+void f64_scale(std::span<const double> values, double factor,
+               std::span<double> out) {
+  Lanes const factors = broadcast(factor);
+  std::size_t const size = out.size();
+  std::size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    store(&out[i], load(&values[i]) * factors);
+  }
+  for (; i < size; ++i) {
+    out[i] = values[i] * factor;
+  }
+}
+
+double f64_dot(std::span<const double> lhs, std::span<const double> rhs) {
+  std::array<Lanes, kAccumulators> acc;
+  acc.fill(broadcast(0.0));
+  std::size_t const size = lhs.size();
+  std::size_t i = 0;
+  for (; i + kBlock <= size; i += kBlock) {
+    for (std::size_t j = 0; j < kAccumulators; ++j) {
+      std::size_t const at = i + j * kLanes;
+      acc[j] += load(&lhs[at]) * load(&rhs[at]);
+    }
+  }
+  Lanes const total = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  double result = total[0] + total[1];
+  for (; i < size; ++i) {
+    result += lhs[i] * rhs[i];
+  }
+  return result;
+}
+
+double f64_sum(std::span<const double> values) {
+  Lanes const total =
+      reduce(values, 0.0, [](Lanes a, Lanes b) { return a + b; });
+  return total[0] + total[1];
+}
+
+double f64_min(std::span<const double> values) {
+  Lanes const lanes =
+      reduce(values, std::numeric_limits<double>::infinity(), lane_min);
+  return lane_min(lanes, Lanes{lanes[1]})[0];
+}
+
+double f64_max(std::span<const double> values) {
+  Lanes const lanes =
+      reduce(values, -std::numeric_limits<double>::infinity(), lane_max);
+  return lane_max(lanes, Lanes{lanes[1]})[0];
+}
+
+}  // namespace lisp
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+
+namespace lisp {
+
+// A fixed-length array of doubles in one contiguous block, aligned for the
+// widest vector registers, so that bulk operations over millions of
+// samples run as tight SIMD loops instead of walking boxed Values.
+class F64Array {
+ public:
+  static constexpr std::size_t kAlignment = 64;
+
+  F64Array() = default;
+  explicit F64Array(std::size_t size, double fill = 0.0);
+
+  F64Array(F64Array&&) noexcept = default;
+  F64Array& operator=(F64Array&&) noexcept = default;
+
+  std::size_t size() const { return count; }
+  double* data() { return values.get(); }
+  const double* data() const { return values.get(); }
+  double& operator[](std::size_t index) { return values[index]; }
+  double operator[](std::size_t index) const { return values[index]; }
+
+  std::span<double> span() { return {values.get(), count}; }
+  std::span<const double> span() const { return {values.get(), count}; }
+
+ private:
+  struct AlignedDelete {
+    void operator()(double* block) const {
+      ::operator delete[](block, std::align_val_t(kAlignment));
+    }
+  };
+
+  std::unique_ptr<double[], AlignedDelete> values;
+  std::size_t count = 0;
+};
+
+// Bulk kernels over arrays of doubles. The element-wise kernels write
+// `out`, which must be as long as the inputs and may be one of them.
+//
+// Reductions accumulate in several independent vector lanes and combine
+// them at the end, so a sum may differ in the last bits from a strictly
+// left-to-right one.
+void f64_add(std::span<const double> lhs, std::span<const double> rhs,
+             std::span<double> out);
+void f64_multiply(std::span<const double> lhs, std::span<const double> rhs,
+                  std::span<double> out);
+void f64_scale(std::span<const double> values, double factor,
+               std::span<double> out);
+
+// The dot product of two arrays of the same length.
+double f64_dot(std::span<const double> lhs, std::span<const double> rhs);
+double f64_sum(std::span<const double> values);
+
+// The least and greatest elements, ignoring NaNs. An array with no other
+// elements gives +inf and -inf respectively.
+double f64_min(std::span<const double> values);
+double f64_max(std::span<const double> values);
+
+}  // namespace lisp
@@ -0,0 +1,93 @@
+#include "fd_stream.hpp"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <memory>
+#include <streambuf>
+
+namespace lisp {
+
+bool write_fully(int fd, const char* data, std::size_t count) {
+  while (count > 0) {
+    ssize_t const written = ::write(fd, data, count);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    count -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+FdOutputBuffer::FdOutputBuffer(int fd)
+    : fd(fd), buffer(std::make_unique<char[]>(kBufferSize)) {
+  setp(buffer.get(), buffer.get() + kBufferSize);
+}
+
+FdOutputBuffer::~FdOutputBuffer() { drain(); }
+
+bool FdOutputBuffer::drain() {
+  bool const ok =
+      write_fully(fd, pbase(), static_cast<std::size_t>(pptr() - pbase()));
+  setp(buffer.get(), buffer.get() + kBufferSize);
+  return ok;
+}
+
+FdOutputBuffer::int_type FdOutputBuffer::overflow(int_type c) {
+  if (!drain()) {
+    return traits_type::eof();
+  }
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+std::streamsize FdOutputBuffer::xsputn(const char* text,
+                                       std::streamsize count) {
+  auto const size = static_cast<std::size_t>(count);
+  if (size <= static_cast<std::size_t>(epptr() - pptr())) {
+    traits_type::copy(pptr(), text, size);
+    pbump(static_cast<int>(count));
+    return count;
+  }
+  if (!drain()) {
+    return 0;
+  }
+  if (size < kBufferSize) {
+    traits_type::copy(pptr(), text, size);
+    pbump(static_cast<int>(count));
+    return count;
+  }
+  return write_fully(fd, text, size) ? count : 0;
+}
+
+int FdOutputBuffer::sync() { return drain() ? 0 : -1; }
+
+FdInputBuffer::FdInputBuffer(int fd)
+    : fd(fd), buffer(std::make_unique<char[]>(kBufferSize)) {
+  setg(buffer.get(), buffer.get(), buffer.get());
+}
+
+FdInputBuffer::int_type FdInputBuffer::underflow() {
+  if (gptr() < egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+  ssize_t count = 0;
+  do {
+    count = ::read(fd, buffer.get(), kBufferSize);
+  } while (count < 0 && errno == EINTR);
+  if (count <= 0) {
+    return traits_type::eof();
+  }
+  setg(buffer.get(), buffer.get(), buffer.get() + count);
+  return traits_type::to_int_type(*gptr());
+}
+
+}  // namespace lisp
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <streambuf>
+
+namespace lisp {
+
+// Stream buffers over POSIX file descriptors with large buffers, so that a
+// script reading or printing millions of lines makes a read(2) or write(2)
+// per 64 KiB rather than per line, with no stdio synchronisation. The
+// descriptor is not closed by the buffer.
+
+class FdOutputBuffer : public std::streambuf {
+ public:
+  static constexpr std::size_t kBufferSize = 64 * 1024;
+
+  explicit FdOutputBuffer(int fd);
+  ~FdOutputBuffer() override;
+  FdOutputBuffer(const FdOutputBuffer&) = delete;
+  FdOutputBuffer& operator=(const FdOutputBuffer&) = delete;
+
+ protected:
+  int_type overflow(int_type c) override;
+  // Writes too large to be worth buffering go straight to the descriptor.
+  std::streamsize xsputn(const char* text, std::streamsize count) override;
+  int sync() override;
+
+ private:
+  int fd;
+  std::unique_ptr<char[]> buffer;
+
+  // Writes out the buffered bytes; returns false on an error.
+  bool drain();
+};
+
+class FdInputBuffer : public std::streambuf {
+ public:
+  static constexpr std::size_t kBufferSize = 64 * 1024;
+
+  explicit FdInputBuffer(int fd);
+  FdInputBuffer(const FdInputBuffer&) = delete;
+  FdInputBuffer& operator=(const FdInputBuffer&) = delete;
+
+ protected:
+  int_type underflow() override;
+
+ private:
+  int fd;
+  std::unique_ptr<char[]> buffer;
+};
+
+// Writes all of `count` bytes at `data` to `fd`, retrying after
+// interruptions and short writes. Returns false on an error.
+bool write_fully(int fd, const char* data, std::size_t count);
+
+}  // namespace lisp
@@ -0,0 +1,241 @@
+#include "gc.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "value.hpp"
+
+namespace lisp {
+
+// Friend of Environment; see collect_cycles() in gc.hpp for the algorithm.
+//
+// The reference count and reachability of each scanned Environment are kept
+// in the Environment itself, so only the values between them need a table.
+class CycleCollector {
+ private:
+  // The reference count not accounted for by other scanned objects, and
+  // whether the object is reachable from one that has such references.
+  struct Node {
+    long external_refs;
+    bool reachable = false;
+  };
+
+  static constexpr long kUncounted = std::numeric_limits<long>::max() / 2;
+
+  // Whether old Environments are scanned too, or treated as roots.
+  bool young_only;
+  std::span<const ValuePtr> value_roots;
+  std::span<Environment* const> env_roots;
+  std::vector<Environment*> environments;
+  std::unordered_map<const Value*, Node> values;
+  std::vector<Environment*> env_worklist;
+  std::vector<const Value*> value_worklist;
+
+  // Only values that can lead to an Environment take part in a cycle.
+  static bool is_container(const Value* value) {
+    return value != nullptr &&
+           (value->is_cons() || value->is_vector() ||
+            value->is_hash_table() || value->is_lambda());
+  }
+
+  bool is_scanned(const Environment* env) const {
+    return env != nullptr && (!young_only || !env->gc_old);
+  }
+
+  template <typename EnvVisitor, typename ValueVisitor>
+  static void for_each_child(const Environment& env, EnvVisitor visit_env,
+                             ValueVisitor visit_value) {
+    for (const ValuePtr& slot : env.slots) {
+      visit_value(slot.get());
+    }
+    env.bindings.for_each_value(
+        [&](const ValuePtr& value) { visit_value(value.get()); });
+    visit_value(env.callee.get());
+    visit_env(env.parent.get());
+  }
+
+  template <typename EnvVisitor, typename ValueVisitor>
+  static void for_each_child(const Value& value, EnvVisitor visit_env,
+                             ValueVisitor visit_value) {
+    if (value.is_cons()) {
+      visit_value(value.car().get());
+      visit_value(value.cdr().get());
+    } else if (value.is_vector()) {
+      for (const ValuePtr& element : value.as_vector()) {
+        visit_value(element.get());
+      }
+    } else if (value.is_hash_table()) {
+      // Keys are numbers, strings and symbols, so only values can lead on.
+      value.as_hash_table().for_each(
+          [&](const ValuePtr& /*key*/, const ValuePtr& entry) {
+            visit_value(entry.get());
+          });
+    } else if (value.is_lambda()) {
+      visit_env(value.as_lambda().closure.get());
+    }
+  }
+
+  // Drains the worklists, calling `visit` on every object popped.
+  template <typename Visitor>
+  void drain(Visitor visit) {
+    while (!env_worklist.empty() || !value_worklist.empty()) {
+      if (!env_worklist.empty()) {
+        Environment* env = env_worklist.back();
+        env_worklist.pop_back();
+        visit(*env);
+      } else {
+        const Value* value = value_worklist.back();
+        value_worklist.pop_back();
+        visit(*value);
+      }
+    }
+  }
+
+  // Records every scanned Environment and every container Value reachable
+  // from one, with its current reference count. Environments are linked
+  // newest first and every survivor of a collection is old, so the young
+  // ones are a prefix of the list.
+  void scan() {
+    for (Environment* env = Environment::gc_head; is_scanned(env);
+         env = env->gc_next) {
+      // Frames not owned by a shared_ptr cannot be counted and are always
+      // treated as roots.
+      long const refs = env->weak_from_this().use_count();
+      env->gc_refs = refs > 0 ? refs : kUncounted;
+      env->gc_reachable = false;
+      environments.push_back(env);
+    }
+    values.reserve(environments.size());
+
+    auto visit_value = [this](const Value* value) {
+      if (is_container(value) && !values.contains(value)) {
+        values.emplace(value, Node{value->weak_from_this().use_count()});
+        value_worklist.push_back(value);
+      }
+    };
+    for (const ValuePtr& root : value_roots) {
+      visit_value(root.get());
+    }
+    env_worklist = environments;
+    drain([&](const auto& object) {
+      for_each_child(object, [](Environment* /*env*/) {}, visit_value);
+    });
+  }
+
+  // Subtracts the references scanned objects hold on each other, leaving
+  // only references from outside the scanned graph.
+  void subtract_internal_references() {
+    auto release_env = [this](Environment* env) {
+      if (is_scanned(env)) {
+        --env->gc_refs;
+      }
+    };
+    auto release_value = [this](const Value* value) {
+      if (auto found = values.find(value); found != values.end()) {
+        --found->second.external_refs;
+      }
+    };
+    for (Environment* env : environments) {
+      for_each_child(*env, release_env, release_value);
+    }
+    for (const auto& entry : values) {
+      for_each_child(*entry.first, release_env, release_value);
+    }
+  }
+
+  // Marks everything reachable from an object with external references.
+  void mark_reachable() {
+    auto reach_env = [this](Environment* env) {
+      if (is_scanned(env) && !env->gc_reachable) {
+        env->gc_reachable = true;
+        env_worklist.push_back(env);
+      }
+    };
+    auto reach_value = [this](const Value* value) {
+      if (auto found = values.find(value);
+          found != values.end() && !found->second.reachable) {
+        found->second.reachable = true;
+        value_worklist.push_back(value);
+      }
+    };
+
+    for (Environment* env : environments) {
+      if (env->gc_refs > 0) {
+        reach_env(env);
+      }
+    }
+    for (const auto& entry : values) {
+      if (entry.second.external_refs > 0) {
+        reach_value(entry.first);
+      }
+    }
+    for (Environment* env : env_roots) {
+      reach_env(env);
+    }
+    for (const ValuePtr& root : value_roots) {
+      reach_value(root.get());
+    }
+    drain([&](const auto& object) {
+      for_each_child(object, reach_env, reach_value);
+    });
+  }
+
+ public:
+  CycleCollector(bool young_only, std::span<const ValuePtr> value_roots,
+                 std::span<Environment* const> env_roots)
+      : young_only(young_only),
+        value_roots(value_roots),
+        env_roots(env_roots) {}
+
+  std::size_t collect() {
+    scan();
+    subtract_internal_references();
+    mark_reachable();
+
+    // Survivors become old. Take ownership of the garbage first so that
+    // nothing is destroyed while bindings are being cleared.
+    std::vector<std::shared_ptr<Environment>> garbage;
+    for (Environment* env : environments) {
+      if (env->gc_reachable) {
+        if (!env->gc_old) {
+          env->gc_old = true;
+          ++Environment::gc_old_count;
+        }
+      } else {
+        garbage.push_back(env->shared_from_this());
+      }
+    }
+    environments.clear();
+    values.clear();
+
+    for (const auto& env : garbage) {
+      env->slots.clear();
+      env->bindings.clear();
+      env->callee.reset();
+      env->slot_names = nullptr;
+      env->parent.reset();
+    }
+    return garbage.size();
+  }
+};
+
+std::size_t collect_cycles() { return collect_cycles({}, {}); }
+
+std::size_t collect_cycles(std::span<const ValuePtr> value_roots,
+                           std::span<Environment* const> env_roots) {
+  CycleCollector collector(false, value_roots, env_roots);
+  return collector.collect();
+}
+
+std::size_t collect_young_cycles(std::span<const ValuePtr> value_roots,
+                                 std::span<Environment* const> env_roots) {
+  CycleCollector collector(true, value_roots, env_roots);
+  return collector.collect();
+}
+
+}  // namespace lisp
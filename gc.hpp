@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include "value.hpp"
+
+namespace lisp {
+
+// Values and Environments are reference counted, which cannot reclaim a
+// closure that captures the frame it is bound in (for example a helper
+// lambda defined inside another lambda's body): the frame holds the closure
+// and the closure holds the frame.
+//
+// collect_cycles() is a tracing collector for that garbage. It scans every
+// live Environment and the lists and closures reachable from them, subtracts
+// the references they hold on one another from their reference counts, and
+// treats anything still referenced from outside (the evaluator's C++ stack,
+// global environments, host code) as a root. Environments not reachable from
+// a root have their bindings cleared, which breaks the cycles and lets
+// reference counting free them.
+//
+// Returns the number of environments reclaimed. Safe to call between
+// top-level evaluations, or mid-evaluation from a point where the
+// evaluator's state is fully held by the given roots: `value_roots` and
+// `env_roots`, and everything reachable from them, are kept regardless of
+// their reference counts.
+std::size_t collect_cycles();
+std::size_t collect_cycles(std::span<const ValuePtr> value_roots,
+                           std::span<Environment* const> env_roots);
+
+// Like collect_cycles(), but scans only the environments created since the
+// last collection, treating older ones as roots. Most closure cycles die
+// young, so this reclaims them at a cost proportional to the new frames
+// rather than to everything alive. Every collection marks its survivors old.
+std::size_t collect_young_cycles(std::span<const ValuePtr> value_roots,
+                                 std::span<Environment* const> env_roots);
+
+}  // namespace lisp
@@ -0,0 +1,257 @@
+#include "image.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bigint.hpp"
+#include "symbol.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+namespace {
+
+constexpr std::uint8_t kImageVersion = 4;
+
+// Each tag is followed by its payload. Lengths, counts and indices are
+// unsigned LEB128 varints.
+enum class Tag : std::uint8_t {
+  END,         // no more forms
+  NIL,         // nil
+  NUMBER,      // u32 low word, u32 high word of the IEEE 754 bits
+  STRING,      // length, bytes
+  SYMBOL_DEF,  // length, bytes; assigns the next symbol index
+  SYMBOL_REF,  // index of a previously defined symbol
+  LIST,        // element count, elements, tail
+  INTEGER,     // u32 low word, u32 high word of the two's complement bits
+  BIGNUM,      // length, decimal digits
+  VECTOR       // element count, elements
+};
+
+}  // namespace
+
+ImageWriter::ImageWriter(std::ostream& output) : output(output) {
+  output.write(kImageMagic.data(),
+               static_cast<std::streamsize>(kImageMagic.size()));
+  write_byte(kImageVersion);
+}
+
+void ImageWriter::write(const ValuePtr& form) { write_datum(*form); }
+
+void ImageWriter::finish() { write_byte(static_cast<std::uint8_t>(Tag::END)); }
+
+void ImageWriter::write_byte(std::uint8_t byte) {
+  output.put(static_cast<char>(byte));
+}
+
+void ImageWriter::write_u32(std::uint32_t word) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    write_byte(static_cast<std::uint8_t>(word >> shift));
+  }
+}
+
+void ImageWriter::write_varint(std::uint32_t value) {
+  while (value >= 0x80) {
+    write_byte(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  write_byte(static_cast<std::uint8_t>(value));
+}
+
+void ImageWriter::write_text(std::string_view text) {
+  write_varint(static_cast<std::uint32_t>(text.size()));
+  output.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+void ImageWriter::write_datum(const Value& datum) {
+  switch (datum.type) {
+    case ValueType::NIL:
+      write_byte(static_cast<std::uint8_t>(Tag::NIL));
+      return;
+    case ValueType::NUMBER: {
+      if (datum.is_bignum()) {
+        write_byte(static_cast<std::uint8_t>(Tag::BIGNUM));
+        write_text(datum.as_bignum().to_string());
+        return;
+      }
+      if (datum.is_integer()) {
+        auto const bits = static_cast<std::uint64_t>(datum.as_integer());
+        write_byte(static_cast<std::uint8_t>(Tag::INTEGER));
+        write_u32(static_cast<std::uint32_t>(bits));
+        write_u32(static_cast<std::uint32_t>(bits >> 32));
+        return;
+      }
+      auto const bits = std::bit_cast<std::uint64_t>(datum.as_number());
+      write_byte(static_cast<std::uint8_t>(Tag::NUMBER));
+      write_u32(static_cast<std::uint32_t>(bits));
+      write_u32(static_cast<std::uint32_t>(bits >> 32));
+      return;
+    }
+    case ValueType::STRING:
+      write_byte(static_cast<std::uint8_t>(Tag::STRING));
+      write_text(datum.as_string());
+      return;
+    case ValueType::SYMBOL: {
+      Symbol const symbol = datum.as_symbol();
+      if (auto found = symbols.find(symbol); found != symbols.end()) {
+        write_byte(static_cast<std::uint8_t>(Tag::SYMBOL_REF));
+        write_varint(found->second);
+        return;
+      }
+      symbols.emplace(symbol, static_cast<std::uint32_t>(symbols.size()));
+      write_byte(static_cast<std::uint8_t>(Tag::SYMBOL_DEF));
+      write_text(symbol.name());
+      return;
+    }
+    case ValueType::CONS: {
+      std::vector<const Value*> elements;
+      const Value* tail = &datum;
+      for (; tail->is_cons(); tail = tail->cdr().get()) {
+        elements.push_back(tail->car().get());
+      }
+      write_byte(static_cast<std::uint8_t>(Tag::LIST));
+      write_varint(static_cast<std::uint32_t>(elements.size()));
+      for (const Value* element : elements) {
+        write_datum(*element);
+      }
+      write_datum(*tail);
+      return;
+    }
+    case ValueType::VECTOR:
+      write_byte(static_cast<std::uint8_t>(Tag::VECTOR));
+      write_varint(static_cast<std::uint32_t>(datum.as_vector().size()));
+      for (const ValuePtr& element : datum.as_vector()) {
+        write_datum(*element);
+      }
+      return;
+    default:
+      throw ImageError("Cannot write to an image: " + datum.to_string());
+  }
+}
+
+ImageReader::ImageReader(std::string_view data) : data(data) {
+  if (!is_image(data)) {
+    throw ImageError("Not a tiny-lisp image");
+  }
+  offset = kImageMagic.size();
+  if (read_byte() != kImageVersion) {
+    throw ImageError("Unsupported image version");
+  }
+}
+
+ValuePtr ImageReader::read() {
+  if (finished) {
+    return nullptr;
+  }
+  std::uint8_t const tag = read_byte();
+  if (tag == static_cast<std::uint8_t>(Tag::END)) {
+    finished = true;
+    return nullptr;
+  }
+  return read_datum(tag);
+}
+
+std::uint8_t ImageReader::read_byte() {
+  if (offset >= data.size()) {
+    throw ImageError("Truncated image");
+  }
+  return static_cast<std::uint8_t>(data[offset++]);
+}
+
+std::uint32_t ImageReader::read_u32() {
+  std::uint32_t word = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    word |= static_cast<std::uint32_t>(read_byte()) << shift;
+  }
+  return word;
+}
+
+std::uint32_t ImageReader::read_varint() {
+  std::uint32_t value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    std::uint8_t const byte = read_byte();
+    value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  throw ImageError("Malformed image");
+}
+
+std::string_view ImageReader::read_text() {
+  std::uint32_t const length = read_varint();
+  if (length > data.size() - offset) {
+    throw ImageError("Truncated image");
+  }
+  std::string_view const text = data.substr(offset, length);
+  offset += length;
+  return text;
+}
+
+ValuePtr ImageReader::read_datum(std::uint8_t tag) {
+  switch (static_cast<Tag>(tag)) {
+    case Tag::NIL:
+      return make_nil();
+    case Tag::NUMBER: {
+      std::uint64_t bits = read_u32();
+      bits |= static_cast<std::uint64_t>(read_u32()) << 32;
+      return make_number(std::bit_cast<double>(bits));
+    }
+    case Tag::INTEGER: {
+      std::uint64_t bits = read_u32();
+      bits |= static_cast<std::uint64_t>(read_u32()) << 32;
+      return make_integer(static_cast<std::int64_t>(bits));
+    }
+    case Tag::VECTOR: {
+      std::uint32_t const count = read_varint();
+      std::vector<ValuePtr> elements;
+      for (std::uint32_t i = 0; i < count; ++i) {
+        elements.push_back(read_datum(read_byte()));
+      }
+      return make_vector(std::move(elements));
+    }
+    case Tag::BIGNUM: {
+      std::optional<BigInt> const number = BigInt::parse(read_text());
+      if (!number) {
+        throw ImageError("Malformed image");
+      }
+      return make_integer(*number);
+    }
+    case Tag::STRING:
+      return make_string(std::string(read_text()));
+    case Tag::SYMBOL_DEF:
+      symbols.push_back(intern(read_text()));
+      return make_symbol(symbols.back());
+    case Tag::SYMBOL_REF: {
+      std::uint32_t const index = read_varint();
+      if (index >= symbols.size()) {
+        throw ImageError("Invalid symbol reference in image");
+      }
+      return make_symbol(symbols[index]);
+    }
+    case Tag::LIST: {
+      std::uint32_t const count = read_varint();
+      std::vector<ValuePtr> elements;
+      for (std::uint32_t i = 0; i < count; ++i) {
+        elements.push_back(read_datum(read_byte()));
+      }
+      ValuePtr result = read_datum(read_byte());
+      for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
+        result = make_cons(*it, result);
+      }
+      return result;
+    }
+    case Tag::END:
+    default:
+      throw ImageError("Malformed image");
+  }
+}
+
+}  // namespace lisp
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "symbol.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+class ImageError : public std::runtime_error {
+ public:
+  explicit ImageError(const std::string& message)
+      : std::runtime_error(message) {}
+};
+
+// A precompiled image is a script's parsed top-level forms in a compact
+// binary encoding, so later runs can skip tokenizing and parsing.
+//
+// The image starts with kImageMagic and a version byte, followed by the
+// forms in order and an END tag. Each datum is a tag byte and its payload;
+// a list is written as its element count, the elements, and its tail.
+// Symbols are spelled out on first use and referred to by index afterwards,
+// so each distinct name is interned once per load. Lengths, counts and
+// indices are varints; numbers are their little-endian IEEE 754 bits.
+inline constexpr std::string_view kImageMagic = "\x7FTLI";
+
+// Returns whether `data` starts like an image.
+inline bool is_image(std::string_view data) {
+  return data.starts_with(kImageMagic);
+}
+
+// Writes forms to an image as they are produced.
+class ImageWriter {
+ private:
+  std::ostream& output;
+  std::unordered_map<Symbol, std::uint32_t> symbols;
+
+  void write_byte(std::uint8_t byte);
+  void write_u32(std::uint32_t word);
+  void write_varint(std::uint32_t value);
+  void write_text(std::string_view text);
+  void write_datum(const Value& datum);
+
+ public:
+  explicit ImageWriter(std::ostream& output);
+
+  // Appends a top-level form. Only data the Parser produces (nil, numbers,
+  // strings, symbols and lists) can be written; anything else throws
+  // ImageError.
+  void write(const ValuePtr& form);
+
+  // Writes the END tag. No forms may be written afterwards.
+  void finish();
+};
+
+// Decodes the forms of an image one at a time, mirroring Reader.
+class ImageReader {
+ private:
+  std::string_view data;
+  std::size_t offset = 0;
+  std::vector<Symbol> symbols;
+  bool finished = false;
+
+  std::uint8_t read_byte();
+  std::uint32_t read_u32();
+  std::uint32_t read_varint();
+  std::string_view read_text();
+  ValuePtr read_datum(std::uint8_t tag);
+
+ public:
+  // `data` must outlive the reader. Throws ImageError if it is not an image
+  // of the current version.
+  explicit ImageReader(std::string_view data);
+
+  // Returns the next top-level form, or nullptr after the last one. Throws
+  // ImageError if the image is truncated or malformed.
+  ValuePtr read();
+};
+
+}  // namespace lisp
@@ -1,59 +1,174 @@
+#include <unistd.h>
+
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <ostream>
 #include <span>
+#include <streambuf>
 #include <string>
 
+#include "fd_stream.hpp"
+#include "image.hpp"
+#include "mapped_file.hpp"
+#include "reader.hpp"
 #include "repl.hpp"
+#include "value.hpp"
 
 namespace {
 
 void print_usage(const std::string& program_name) {
-  std::cout << "Usage: " << program_name << " [file]\n";
+  std::cout << "Usage: " << program_name << " [--vm] [file]\n";
+  std::cout << "       " << program_name
+            << " --compile-image output file\n";
   std::cout << "  If no file is provided, starts interactive REPL mode.\n";
   std::cout << "  If file is provided, evaluates the file and exits.\n";
+  std::cout << "  --vm runs programs on the bytecode virtual machine.\n";
+  std::cout << "  --compile-image writes the parsed forms of file to output;\n";
+  std::cout << "  running output later skips tokenizing and parsing.\n";
+}
+
+// While alive, std::cout and std::cin go through large buffers straight
+// to the standard output and input descriptors, unsynchronised with stdio
+// and untied, so a script's output is written in large blocks when a
+// buffer fills, the script calls (flush), or the script ends.
+class BatchStdio {
+ private:
+  lisp::FdOutputBuffer output{STDOUT_FILENO};
+  lisp::FdInputBuffer input{STDIN_FILENO};
+  std::streambuf* saved_output;
+  std::streambuf* saved_input;
+  std::ostream* saved_tie;
+
+ public:
+  BatchStdio() {
+    std::ios::sync_with_stdio(false);
+    saved_output = std::cout.rdbuf(&output);
+    saved_input = std::cin.rdbuf(&input);
+    saved_tie = std::cin.tie(nullptr);
+  }
+
+  ~BatchStdio() {
+    std::cout.flush();
+    std::cout.rdbuf(saved_output);
+    std::cin.rdbuf(saved_input);
+    std::cin.tie(saved_tie);
+  }
+
+  BatchStdio(const BatchStdio&) = delete;
+  BatchStdio& operator=(const BatchStdio&) = delete;
+};
+
+// Evaluates a script or precompiled image and prints the last result.
+int run_file(lisp::REPL& repl, const std::string& filename) {
+  BatchStdio const stdio;
+
+  // Regular files are mapped and read in place; anything else, such as a
+  // pipe, is read as a stream.
+  lisp::ValuePtr result;
+  lisp::MappedFile const mapped(filename);
+  if (mapped.is_mapped()) {
+    result = lisp::is_image(mapped.contents())
+                 ? repl.eval_image(mapped.contents())
+                 : repl.eval_source(mapped.contents());
+  } else {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "Error: Could not open file '" << filename << "'\n";
+      return 1;
+    }
+    // Only input that could be an image is read whole; it is then
+    // classified on the full magic, as a mapped file is.
+    if (file.peek() == lisp::kImageMagic[0]) {
+      std::string const contents((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+      result = lisp::is_image(contents) ? repl.eval_image(contents)
+                                        : repl.eval_source(contents);
+    } else {
+      result = repl.eval_stream(file);
+    }
+  }
+
+  if (result) {
+    lisp::print_value(*result, std::cout);
+    std::cout << '\n';
+  }
+  return 0;
+}
+
+// Parses the script `filename` and writes its forms to the image `output`.
+int compile_image(const std::string& filename, const std::string& output) {
+  std::ifstream file;
+  lisp::MappedFile const mapped(filename);
+  if (!mapped.is_mapped()) {
+    file.open(filename);
+    if (!file.is_open()) {
+      std::cerr << "Error: Could not open file '" << filename << "'\n";
+      return 1;
+    }
+  }
+
+  std::ofstream image(output, std::ios::binary | std::ios::trunc);
+  if (!image.is_open()) {
+    std::cerr << "Error: Could not open file '" << output << "'\n";
+    return 1;
+  }
+
+  lisp::Reader reader = mapped.is_mapped() ? lisp::Reader(mapped.contents())
+                                           : lisp::Reader(file);
+  lisp::ImageWriter writer(image);
+  while (lisp::ValuePtr const form = reader.read()) {
+    writer.write(form);
+  }
+  writer.finish();
+
+  image.close();
+  if (!image) {
+    std::cerr << "Error: Could not write file '" << output << "'\n";
+    return 1;
+  }
+  return 0;
 }
 
 }  // namespace
 
 int main(int argc, char* argv[]) {
   auto args = std::span(argv, argc);
+  std::string const program_name = args[0];
+
+  auto operands = args.subspan(1);
+  auto engine = lisp::Evaluator::Engine::TREE_WALKER;
+  if (!operands.empty() && std::string(operands[0]) == "--vm") {
+    engine = lisp::Evaluator::Engine::BYTECODE;
+    operands = operands.subspan(1);
+  }
+
   try {
-    lisp::REPL repl;
+    if (!operands.empty() && std::string(operands[0]) == "--compile-image") {
+      if (operands.size() != 3) {
+        print_usage(program_name);
+        return 1;
+      }
+      return compile_image(operands[2], operands[1]);
+    }
 
-    if (argc == 1) {
+    lisp::REPL repl(engine);
+
+    if (operands.empty()) {
       // Interactive mode
       repl.run();
-    } else if (argc == 2) {
-      std::string const program_name = args[0];
-      std::string const filename = args[1];
+    } else if (operands.size() == 1) {
+      std::string const filename = operands[0];
 
       if (filename == "--help" || filename == "-h") {
         print_usage(program_name);
         return 0;
       }
 
-      std::ifstream file(filename);
-      if (!file.is_open()) {
-        std::cerr << "Error: Could not open file '" << filename << "'\n";
-        return 1;
-      }
-
-      std::string content;
-      std::string line;
-      while (std::getline(file, line)) {
-        content += line + "\n";
-      }
-      file.close();
-
-      if (!content.empty()) {
-        auto result = repl.eval_string(content);
-        if (result) {
-          std::cout << result->to_string() << '\n';
-        }
-      }
+      return run_file(repl, filename);
     } else {
-      print_usage(args[0]);
+      print_usage(program_name);
       return 1;
     }
   } catch (const std::exception& e) {
@@ -62,4 +177,4 @@ int main(int argc, char* argv[]) {
   }
 
   return 0;
-}
\ No newline at end of file
+}
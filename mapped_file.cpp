@@ -0,0 +1,42 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <string>
+
+namespace lisp {
+
+MappedFile::MappedFile(const std::string& path) {
+  int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat info {};
+  if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    auto const length = static_cast<std::size_t>(info.st_size);
+    void* const region =
+        ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (region != MAP_FAILED) {
+      // Scripts are read once from front to back.
+      ::madvise(region, length, MADV_SEQUENTIAL);
+      data = region;
+      size = length;
+    }
+  }
+
+  // The mapping stays valid after the descriptor is closed.
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data != nullptr) {
+    ::munmap(data, size);
+  }
+}
+
+}  // namespace lisp
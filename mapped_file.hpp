@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace lisp {
+
+// A regular file mapped read-only into memory, so its contents can be
+// tokenized in place without being read into a buffer first.
+//
+// Mapping is best effort: pipes, terminals and other non-regular files (as
+// well as empty or unreadable ones) are left unmapped, and callers fall back
+// to reading them as a stream.
+class MappedFile {
+ private:
+  void* data = nullptr;
+  std::size_t size = 0;
+
+ public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool is_mapped() const { return data != nullptr; }
+
+  // The mapped bytes; empty if the file is not mapped.
+  std::string_view contents() const {
+    return is_mapped() ? std::string_view(static_cast<const char*>(data), size)
+                       : std::string_view();
+  }
+};
+
+}  // namespace lisp
@@ -1,17 +1,52 @@
 #include "parser.hpp"
 
+#include <charconv>
 #include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <utility>
 #include <vector>
 
+#include "bigint.hpp"
 #include "tokenizer.hpp"
 #include "value.hpp"
 
 namespace lisp {
 
-Parser::Parser(const std::vector<Token>& tokens)
-    : tokens(tokens), position(0) {}
+namespace {
+
+// Returns the integer written as `text`, or nullptr if it has a fraction and
+// so must be read as a double. Integers too large for 64 bits are read as
+// bignums.
+ValuePtr parse_integer(std::string_view text) {
+  std::string_view digits = text;
+  if (digits.starts_with('+')) {
+    digits.remove_prefix(1);
+  }
+  std::int64_t value = 0;
+  auto const [end, error] =
+      std::from_chars(digits.data(), digits.data() + digits.size(), value);
+  if (end != digits.data() + digits.size()) {
+    return nullptr;
+  }
+  if (error == std::errc::result_out_of_range) {
+    if (std::optional<BigInt> big = BigInt::parse(text)) {
+      return make_integer(*big);
+    }
+  }
+  if (error != std::errc()) {
+    return nullptr;
+  }
+  return make_integer(value);
+}
+
+}  // namespace
+
+Parser::Parser(std::vector<Token> tokens)
+    : tokens(std::move(tokens)), position(0) {}
 
 const Token& Parser::current_token() const {
   if (position >= tokens.size()) {
@@ -46,11 +81,16 @@ ValuePtr Parser::parse_atom() {
 
   switch (token.type()) {
     case TokenType::NUMBER: {
-      double const value = std::stod(token.value());
+      if (ValuePtr integer = parse_integer(token.value())) {
+        return integer;
+      }
+      // Number literals fit std::string's small buffer, so this rarely
+      // allocates.
+      double const value = std::stod(std::string(token.value()));
       return make_number(value);
     }
     case TokenType::STRING: {
-      return make_string(token.value());
+      return make_string(std::string(token.value()));
     }
     case TokenType::SYMBOL: {
       if (token.value() == "nil") {
@@ -59,7 +99,7 @@ ValuePtr Parser::parse_atom() {
       return make_symbol(token.value());
     }
     default:
-      throw ParseError("Unexpected token: " + token.value());
+      throw ParseError("Unexpected token: " + std::string(token.value()));
   }
 }
 
@@ -97,6 +137,22 @@ ValuePtr Parser::parse_list() {
   return result;
 }
 
+ValuePtr Parser::parse_vector() {
+  advance();  // consume '#('
+
+  std::vector<ValuePtr> elements;
+  while (current_token().type() != TokenType::RPAREN && !is_at_end()) {
+    elements.push_back(parse());
+  }
+
+  if (current_token().type() != TokenType::RPAREN) {
+    throw ParseError("Expected ')' at end of vector");
+  }
+  advance();  // consume ')'
+
+  return make_vector(std::move(elements));
+}
+
 ValuePtr Parser::parse_quoted() {
   if (current_token().type() != TokenType::QUOTE) {
     throw ParseError("Expected quote");
@@ -120,6 +176,8 @@ ValuePtr Parser::parse() {
   switch (token.type()) {
     case TokenType::LPAREN:
       return parse_list();
+    case TokenType::VECTOR_START:
+      return parse_vector();
     case TokenType::QUOTE:
       return parse_quoted();
     case TokenType::NUMBER:
@@ -127,7 +185,7 @@ ValuePtr Parser::parse() {
     case TokenType::SYMBOL:
       return parse_atom();
     default:
-      throw ParseError("Unexpected token: " + token.value());
+      throw ParseError("Unexpected token: " + std::string(token.value()));
   }
 }
 
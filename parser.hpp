@@ -25,10 +25,11 @@ class Parser {
 
   ValuePtr parse_atom();
   ValuePtr parse_list();
+  ValuePtr parse_vector();
   ValuePtr parse_quoted();
 
  public:
-  explicit Parser(const std::vector<Token>& tokens);
+  explicit Parser(std::vector<Token> tokens);
   ValuePtr parse();
   std::vector<ValuePtr> parse_multiple();
 };
@@ -0,0 +1,79 @@
+#include "pool.hpp"
+
+#include <array>
+#include <cstddef>
+#include <new>
+
+namespace lisp {
+
+namespace {
+
+constexpr std::size_t kGranularity = 16;
+constexpr std::size_t kMaxPooledSize = 256;
+constexpr std::size_t kChunkSize = 64 * 1024;
+constexpr std::size_t kSizeClasses = kMaxPooledSize / kGranularity;
+
+struct FreeNode {
+  FreeNode* next;
+};
+
+struct Pool {
+  std::array<FreeNode*, kSizeClasses> free_lists{};
+  char* chunk_next = nullptr;
+  char* chunk_end = nullptr;
+};
+
+Pool& pool() {
+  // Never destroyed: pooled objects may still be released during static
+  // destruction.
+  static Pool* const instance = new Pool;
+  return *instance;
+}
+
+std::size_t size_class(std::size_t bytes) {
+  return (bytes + kGranularity - 1) / kGranularity - 1;
+}
+
+}  // namespace
+
+void* pool_allocate(std::size_t bytes) {
+  if (bytes == 0 || bytes > kMaxPooledSize) {
+    return ::operator new(bytes);
+  }
+
+  Pool& instance = pool();
+  std::size_t const index = size_class(bytes);
+
+  if (FreeNode* node = instance.free_lists[index]; node != nullptr) {
+    instance.free_lists[index] = node->next;
+    return node;
+  }
+
+  std::size_t const rounded = (index + 1) * kGranularity;
+  if (instance.chunk_end - instance.chunk_next <
+      static_cast<std::ptrdiff_t>(rounded)) {
+    // The tail of the previous chunk is abandoned; it is smaller than the
+    // largest size class, so at most a few hundred bytes per 64 KiB.
+    instance.chunk_next = static_cast<char*>(::operator new(kChunkSize));
+    instance.chunk_end = instance.chunk_next + kChunkSize;
+  }
+
+  void* result = instance.chunk_next;
+  instance.chunk_next += rounded;
+  return result;
+}
+
+void pool_deallocate(void* ptr, std::size_t bytes) noexcept {
+  if (bytes == 0 || bytes > kMaxPooledSize) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  Pool& instance = pool();
+  std::size_t const index = size_class(bytes);
+  auto* node = static_cast<FreeNode*>(ptr);
+  node->next = instance.free_lists[index];
+  instance.free_lists[index] = node;
+}
+
+}  // namespace lisp
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+namespace lisp {
+
+// Size-class pool for the small, short-lived objects the interpreter creates
+// on every step (Values and their shared_ptr control blocks). Requests are
+// rounded up to a multiple of 16 bytes and served from per-size free lists
+// refilled from large chunks; larger requests go to operator new. Memory is
+// recycled within its size class and never returned to the system.
+void* pool_allocate(std::size_t bytes);
+void pool_deallocate(void* ptr, std::size_t bytes) noexcept;
+
+// Standard allocator over the pool, for use with std::allocate_shared.
+template <typename T>
+struct PoolAllocator {
+  using value_type = T;
+
+  PoolAllocator() = default;
+
+  template <typename U>
+  // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+  PoolAllocator(const PoolAllocator<U>& /*other*/) noexcept {}
+
+  T* allocate(std::size_t count) {
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+    return static_cast<T*>(pool_allocate(count * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, std::size_t count) noexcept {
+    pool_deallocate(ptr, count * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U>& /*other*/) const noexcept {
+    return true;
+  }
+};
+
+}  // namespace lisp
@@ -0,0 +1,50 @@
+#include "port.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "fd_stream.hpp"
+
+namespace lisp {
+
+std::unique_ptr<Port> Port::open(const std::string& path,
+                                 Direction direction) {
+  int const fd =
+      direction == Direction::INPUT
+          ? ::open(path.c_str(), O_RDONLY | O_CLOEXEC)
+          : ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                   0666);
+  if (fd < 0) {
+    return nullptr;
+  }
+  return std::unique_ptr<Port>(new Port(fd, direction));
+}
+
+Port::Port(int fd, Direction direction)
+    : fd(fd), direction(direction), text(nullptr) {
+  if (direction == Direction::INPUT) {
+    buffer = std::make_unique<FdInputBuffer>(fd);
+  } else {
+    buffer = std::make_unique<FdOutputBuffer>(fd);
+  }
+  text.rdbuf(buffer.get());
+}
+
+Port::~Port() { close(); }
+
+bool Port::close() {
+  if (fd < 0) {
+    return true;
+  }
+  bool const flushed = buffer->pubsync() == 0;
+  text.rdbuf(nullptr);
+  buffer.reset();
+  bool const closed = ::close(fd) == 0;
+  fd = -1;
+  return flushed && closed;
+}
+
+}  // namespace lisp
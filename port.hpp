@@ -0,0 +1,46 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+namespace lisp {
+
+// A file opened for reading or writing by a script. Reads and writes go
+// through an FdInputBuffer or FdOutputBuffer, so they reach the file in
+// 64 KiB blocks. The file is closed by close() or when the port is
+// destroyed.
+class Port {
+ public:
+  enum class Direction { INPUT, OUTPUT };
+
+  // Opens `path` for reading, or creates or truncates it for writing.
+  // Returns nullptr (with errno set) if it cannot be opened.
+  static std::unique_ptr<Port> open(const std::string& path,
+                                    Direction direction);
+
+  ~Port();
+  Port(const Port&) = delete;
+  Port& operator=(const Port&) = delete;
+
+  bool is_input() const { return direction == Direction::INPUT; }
+  bool is_open() const { return fd >= 0; }
+
+  // The port's stream; only the side matching its direction is usable.
+  std::iostream& stream() { return text; }
+
+  // Writes out buffered output and closes the file. Returns false if
+  // either fails. Closing a closed port does nothing.
+  bool close();
+
+ private:
+  int fd;
+  Direction direction;
+  std::unique_ptr<std::streambuf> buffer;
+  std::iostream text;
+
+  Port(int fd, Direction direction);
+};
+
+}  // namespace lisp
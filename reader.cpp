@@ -0,0 +1,144 @@
+#include "reader.hpp"
+
+#include <cctype>
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "parser.hpp"
+#include "tokenizer.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+namespace {
+
+// Characters that end a symbol or number, matching Tokenizer::read_symbol.
+bool is_delimiter(char glyph) {
+  return std::isspace(static_cast<unsigned char>(glyph)) != 0 ||
+         glyph == '(' || glyph == ')' || glyph == '"' || glyph == ';';
+}
+
+}  // namespace
+
+Reader::Reader(std::istream& input) : stream(input.rdbuf()) {}
+
+Reader::Reader(std::string_view input) : source(input) {}
+
+int Reader::peek_char() {
+  if (stream != nullptr) {
+    return stream->sgetc();
+  }
+  return offset < source.size()
+             ? std::char_traits<char>::to_int_type(source[offset])
+             : std::char_traits<char>::eof();
+}
+
+void Reader::next_char() {
+  if (stream != nullptr) {
+    text += std::char_traits<char>::to_char_type(stream->sbumpc());
+  } else {
+    ++offset;
+  }
+}
+
+ValuePtr Reader::read() {
+  while (pending.empty()) {
+    if (!read_datum()) {
+      return nullptr;
+    }
+
+    // A single datum's text can still hold more than one form (for example
+    // "12abc" is a number followed by a symbol), so parse all of it.
+    Tokenizer tokenizer(datum);
+    Parser parser(tokenizer.tokenize());
+    for (ValuePtr& form : parser.parse_multiple()) {
+      pending.push_back(std::move(form));
+    }
+  }
+
+  ValuePtr form = std::move(pending.front());
+  pending.pop_front();
+  return form;
+}
+
+bool Reader::read_datum() {
+  text.clear();
+  std::size_t const start = offset;
+  int depth = 0;
+  bool in_atom = false;
+  bool in_string = false;
+  bool in_comment = false;
+  bool escaped = false;
+  bool complete = false;
+
+  for (int next = peek_char(); next != std::char_traits<char>::eof();
+       next = peek_char()) {
+    char const glyph = std::char_traits<char>::to_char_type(next);
+
+    if (in_atom && is_delimiter(glyph)) {
+      in_atom = false;
+      if (depth == 0) {
+        complete = true;  // Leave the delimiter for the next datum.
+        break;
+      }
+    }
+    next_char();
+
+    if (in_comment) {
+      in_comment = glyph != '\n';
+    } else if (in_string) {
+      if (escaped) {
+        escaped = false;
+      } else if (glyph == '\\') {
+        escaped = true;
+      } else if (glyph == '"') {
+        in_string = false;
+        complete = depth == 0;
+      }
+    } else if (!in_atom) {
+      switch (glyph) {
+        case ';':
+          in_comment = true;
+          break;
+        case '"':
+          in_string = true;
+          break;
+        case '(':
+          ++depth;
+          break;
+        case '#':
+          // "#(" opens a vector; otherwise '#' starts an atom such as #t.
+          in_atom = peek_char() != '(';
+          break;
+        case ')':
+          // An unbalanced ')' is returned on its own for Parser to reject.
+          depth = depth > 0 ? depth - 1 : 0;
+          complete = depth == 0;
+          break;
+        default:
+          in_atom = std::isspace(static_cast<unsigned char>(glyph)) == 0 &&
+                    glyph != '\'';
+          break;
+      }
+    }
+
+    if (complete) {
+      break;
+    }
+  }
+
+  datum = stream != nullptr ? std::string_view(text)
+                            : source.substr(start, offset - start);
+  if (complete) {
+    return true;
+  }
+
+  // End of input: return whatever was read, so that an unterminated form is
+  // reported by Parser.
+  return datum.find_first_not_of(" \t\n\r\f\v") != std::string_view::npos;
+}
+
+}  // namespace lisp
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <istream>
+#include <string>
+#include <string_view>
+
+#include "value.hpp"
+
+namespace lisp {
+
+// Reads top-level forms one at a time, so a script can be evaluated as it is
+// read and only the form being read is held in memory.
+//
+// Characters are consumed up to the end of the next complete top-level datum
+// (an atom, a string, a balanced list, or a quoted datum) and that text is
+// handed to Tokenizer and Parser. Forms are split exactly as
+// Parser::parse_multiple would split the whole input, and parse errors are
+// the ones it would report.
+//
+// The source is either a stream, whose datum text is copied into a buffer,
+// or text already in memory (such as a MappedFile), which is tokenized in
+// place and must outlive the Reader.
+class Reader {
+ private:
+  std::streambuf* stream = nullptr;
+  std::string_view source;
+  std::size_t offset = 0;         // Read position in `source`.
+  std::string text;               // Datum text copied from `stream`.
+  std::string_view datum;         // Source of the datum being read.
+  std::deque<ValuePtr> pending;  // Parsed forms not yet returned.
+
+  int peek_char();
+  void next_char();
+
+  // Points `datum` at the source of the next top-level datum. Returns false
+  // if only whitespace and comments remain.
+  bool read_datum();
+
+ public:
+  explicit Reader(std::istream& input);
+  explicit Reader(std::string_view input);
+
+  // Returns the next top-level form, or nullptr at end of input. Throws
+  // ParseError for a malformed form; reading may continue after it.
+  ValuePtr read();
+};
+
+}  // namespace lisp
@@ -2,10 +2,15 @@
 
 #include <exception>
 #include <iostream>
+#include <istream>
 #include <string>
+#include <string_view>
+#include <utility>
 
 #include "evaluator.hpp"
+#include "image.hpp"
 #include "parser.hpp"
+#include "reader.hpp"
 #include "tokenizer.hpp"
 #include "value.hpp"
 
@@ -30,7 +35,8 @@ void print_welcome() {
 }
 
 void print_result(const ValuePtr& result) {
-  std::cout << result->to_string() << '\n';
+  print_value(*result, std::cout);
+  std::cout << '\n';
 }
 
 void print_error(const std::exception& exn) {
@@ -46,7 +52,7 @@ ValuePtr REPL::eval_string(const std::string& input) {
   Tokenizer tokenizer(input);
   auto tokens = tokenizer.tokenize();
 
-  Parser parser(tokens);
+  Parser parser(std::move(tokens));
   auto expressions = parser.parse_multiple();
 
   ValuePtr result = {};
@@ -57,6 +63,31 @@ ValuePtr REPL::eval_string(const std::string& input) {
   return result;
 }
 
+template <typename FormReader>
+ValuePtr REPL::eval_forms(FormReader& reader) {
+  ValuePtr result = {};
+  while (ValuePtr const expr = reader.read()) {
+    result = evaluator.eval(expr);
+  }
+
+  return result;
+}
+
+ValuePtr REPL::eval_stream(std::istream& input) {
+  Reader reader(input);
+  return eval_forms(reader);
+}
+
+ValuePtr REPL::eval_source(std::string_view input) {
+  Reader reader(input);
+  return eval_forms(reader);
+}
+
+ValuePtr REPL::eval_image(std::string_view image) {
+  ImageReader reader(image);
+  return eval_forms(reader);
+}
+
 void REPL::run() {
   print_welcome();
   running = true;
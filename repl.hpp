@@ -1,6 +1,8 @@
 #pragma once
 
+#include <istream>
 #include <string>
+#include <string_view>
 
 #include "evaluator.hpp"
 #include "value.hpp"
@@ -12,14 +14,31 @@ class REPL {
   Evaluator evaluator;
   bool running = false;
 
+  // Evaluates the forms returned by `reader` (a Reader or ImageReader) as
+  // they are read.
+  template <typename FormReader>
+  ValuePtr eval_forms(FormReader& reader);
+
  public:
-  REPL() = default;
+  explicit REPL(Evaluator::Engine engine = Evaluator::Engine::TREE_WALKER)
+      : evaluator(engine) {}
 
   void run();
   void stop();
 
   // For non-interactive evaluation
   ValuePtr eval_string(const std::string& input);
+
+  // Evaluates each top-level form in `input` as soon as it has been read and
+  // returns the value of the last one (nullptr if there were none).
+  ValuePtr eval_stream(std::istream& input);
+
+  // As eval_stream, for source text already in memory (such as a
+  // MappedFile), which is tokenized in place without being copied.
+  ValuePtr eval_source(std::string_view input);
+
+  // As eval_source, for a precompiled image written by ImageWriter.
+  ValuePtr eval_image(std::string_view image);
 };
 
 }  // namespace lisp
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "shared_string.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lisp {
+
+// Either a buffer of characters or, until it is flattened, the two halves
+// of a concatenation. Flattening fills in `text` and drops the halves;
+// Values are only used from one thread, so this needs no synchronisation.
+struct SharedString::Node {
+  mutable std::string text;
+  mutable SharedString left;
+  mutable SharedString right;
+  mutable bool flat = true;
+  std::uint32_t depth = 0;
+
+  void flatten() const {
+    if (flat) {
+      return;
+    }
+    std::string joined;
+    joined.reserve(left.size() + right.size());
+    left.append_to(joined);
+    right.append_to(joined);
+    text = std::move(joined);
+    left = SharedString();
+    right = SharedString();
+    flat = true;
+  }
+};
+
+SharedString::SharedString(std::string text) : length(text.size()) {
+  if (length != 0) {
+    auto buffer = std::make_shared<Node>();
+    buffer->text = std::move(text);
+    node = std::move(buffer);
+  }
+}
+
+SharedString::SharedString(std::shared_ptr<const Node> node,
+                           std::size_t offset, std::size_t length)
+    : node(std::move(node)), offset(offset), length(length) {}
+
+SharedString SharedString::concat(const SharedString& lhs,
+                                  const SharedString& rhs) {
+  if (lhs.empty()) {
+    return rhs;
+  }
+  if (rhs.empty()) {
+    return lhs;
+  }
+  if (lhs.size() + rhs.size() < kMinRopeLength) {
+    return join(lhs, rhs);
+  }
+  // Appending a short piece to a rope, as when building a string a line at
+  // a time, writes it into spare room at the end of the rope's right-hand
+  // leaf. A short leaf without such room is copied once into one that has
+  // it, and a full one is followed by a new leaf.
+  SharedString tail = rhs;
+  if (lhs.depth() != 0 && rhs.depth() == 0 && rhs.size() < kMaxLeafLength) {
+    const Node& rope = *lhs.node;
+    if (rope.right.depth() == 0) {
+      if (std::optional<SharedString> extended = rope.right.extend(rhs)) {
+        return make_rope(rope.left, *extended);
+      }
+      if (rope.right.size() + rhs.size() <= kMaxLeafLength) {
+        return make_rope(rope.left, make_leaf(rope.right, rhs));
+      }
+    }
+    tail = make_leaf(SharedString(), rhs);
+  }
+  if (std::max(lhs.depth(), tail.depth()) >= kMaxDepth) {
+    std::vector<SharedString> leaves;
+    lhs.collect_leaves(leaves);
+    tail.collect_leaves(leaves);
+    return balance(leaves, 0, leaves.size());
+  }
+  return make_rope(lhs, tail);
+}
+
+SharedString SharedString::join(const SharedString& lhs,
+                                const SharedString& rhs) {
+  std::string text;
+  text.reserve(lhs.size() + rhs.size());
+  lhs.append_to(text);
+  rhs.append_to(text);
+  return SharedString(std::move(text));
+}
+
+SharedString SharedString::make_leaf(const SharedString& lhs,
+                                     const SharedString& rhs) {
+  std::string text;
+  text.reserve(kMaxLeafLength);
+  lhs.append_to(text);
+  rhs.append_to(text);
+  return SharedString(std::move(text));
+}
+
+std::optional<SharedString> SharedString::extend(
+    const SharedString& rhs) const {
+  if (!node || !node->flat) {
+    return std::nullopt;
+  }
+  std::string& text = node->text;
+  // Characters past this string's end belong to another extension, and
+  // growing the buffer would move characters that views still point to.
+  if (offset + length != text.size() ||
+      text.size() + rhs.size() > text.capacity()) {
+    return std::nullopt;
+  }
+  rhs.append_to(text);
+  return SharedString(node, offset, length + rhs.size());
+}
+
+SharedString SharedString::make_rope(const SharedString& lhs,
+                                     const SharedString& rhs) {
+  auto rope = std::make_shared<Node>();
+  rope->left = lhs;
+  rope->right = rhs;
+  rope->flat = false;
+  rope->depth = std::max(lhs.depth(), rhs.depth()) + 1;
+  return SharedString(std::move(rope), 0, lhs.size() + rhs.size());
+}
+
+SharedString SharedString::balance(const std::vector<SharedString>& leaves,
+                                   std::size_t begin, std::size_t end) {
+  if (end - begin == 1) {
+    return leaves[begin];
+  }
+  std::size_t const middle = begin + (end - begin) / 2;
+  return make_rope(balance(leaves, begin, middle),
+                   balance(leaves, middle, end));
+}
+
+std::string_view SharedString::view() const {
+  if (!node) {
+    return {};
+  }
+  node->flatten();
+  return std::string_view(node->text).substr(offset, length);
+}
+
+SharedString SharedString::substr(std::size_t pos, std::size_t count) const {
+  if (count == 0) {
+    return SharedString();
+  }
+  node->flatten();
+  return SharedString(node, offset + pos, count);
+}
+
+std::uint32_t SharedString::depth() const {
+  return node && !node->flat ? node->depth : 0;
+}
+
+// Recurses at most kMaxDepth levels.
+void SharedString::collect_leaves(std::vector<SharedString>& leaves) const {
+  if (depth() == 0) {
+    leaves.push_back(*this);
+    return;
+  }
+  node->left.collect_leaves(leaves);
+  node->right.collect_leaves(leaves);
+}
+
+// Recurses at most kMaxDepth levels.
+void SharedString::append_to(std::string& out) const {
+  if (!node) {
+    return;
+  }
+  if (node->flat) {
+    out.append(node->text, offset, length);
+    return;
+  }
+  node->left.append_to(out);
+  node->right.append_to(out);
+}
+
+}  // namespace lisp
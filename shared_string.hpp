@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lisp {
+
+// An immutable string whose characters live in a reference-counted buffer
+// shared by every copy, so copying one, or taking a substring of it, does
+// not copy any characters. A substring keeps the whole buffer alive.
+//
+// Concatenating long strings builds a rope: a node referring to both
+// halves, flattened into one buffer the first time its characters are
+// needed. Short pieces appended one after another are written into spare
+// room at the end of the rope's last leaf, up to kMaxLeafLength characters
+// per leaf, and a rope that reaches kMaxDepth is rebuilt as a balanced tree
+// over the same leaves, which bounds the cost of flattening and destroying
+// it without copying any characters.
+class SharedString {
+ public:
+  // Concatenations shorter than this are copied rather than made ropes.
+  static constexpr std::size_t kMinRopeLength = 128;
+  static constexpr std::size_t kMaxLeafLength = 4096;
+  static constexpr std::uint32_t kMaxDepth = 64;
+
+  SharedString() = default;
+  explicit SharedString(std::string text);
+
+  static SharedString concat(const SharedString& lhs, const SharedString& rhs);
+
+  std::size_t size() const { return length; }
+  // Levels of concatenation below this string; zero once it is flat.
+  std::uint32_t depth() const;
+  bool empty() const { return length == 0; }
+
+  // The characters, in one contiguous block.
+  std::string_view view() const;
+
+  // The `count` characters from `pos`; both must be within the string. A
+  // rope is flattened first.
+  SharedString substr(std::size_t pos, std::size_t count) const;
+
+  friend bool operator==(const SharedString& lhs, const SharedString& rhs) {
+    return lhs.view() == rhs.view();
+  }
+
+ private:
+  struct Node;
+
+  std::shared_ptr<const Node> node;
+  std::size_t offset = 0;
+  std::size_t length = 0;
+
+  SharedString(std::shared_ptr<const Node> node, std::size_t offset,
+               std::size_t length);
+
+  // A flat copy of `lhs` followed by `rhs`.
+  static SharedString join(const SharedString& lhs, const SharedString& rhs);
+  // A flat copy of `lhs` followed by `rhs`, with room to be extended up to
+  // kMaxLeafLength characters.
+  static SharedString make_leaf(const SharedString& lhs,
+                                const SharedString& rhs);
+  static SharedString make_rope(const SharedString& lhs,
+                                const SharedString& rhs);
+  // This flat string followed by `rhs`, written into spare capacity after
+  // it in the same buffer, if it ends the buffer and there is room.
+  std::optional<SharedString> extend(const SharedString& rhs) const;
+  // A rope of minimal depth over `leaves`, which must not be empty.
+  static SharedString balance(const std::vector<SharedString>& leaves,
+                              std::size_t begin, std::size_t end);
+
+  // Appends the flat pieces of this string, in order, to `leaves`.
+  void collect_leaves(std::vector<SharedString>& leaves) const;
+  void append_to(std::string& out) const;
+};
+
+}  // namespace lisp
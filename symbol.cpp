@@ -0,0 +1,41 @@
+#include "symbol.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace lisp {
+
+namespace {
+
+struct SymbolTable {
+  // std::deque never relocates existing elements, so entry addresses (and
+  // the string_view keys pointing into them) stay valid as the table grows.
+  std::deque<Symbol::Entry> entries;
+  std::unordered_map<std::string_view, const Symbol::Entry*> index;
+};
+
+SymbolTable& symbol_table() {
+  static SymbolTable table;
+  return table;
+}
+
+}  // namespace
+
+Symbol intern(std::string_view name) {
+  SymbolTable& table = symbol_table();
+
+  if (auto found = table.index.find(name); found != table.index.end()) {
+    return Symbol(found->second);
+  }
+
+  const Symbol::Entry& entry = table.entries.emplace_back(
+      Symbol::Entry{std::string(name),
+                    static_cast<std::uint32_t>(table.entries.size())});
+  table.index.emplace(entry.name, &entry);
+  return Symbol(&entry);
+}
+
+}  // namespace lisp
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace lisp {
+
+// An interned symbol name. Every occurrence of the same text maps to the same
+// table entry, so symbols compare and hash by identity instead of by
+// characters. Entries live for the lifetime of the program.
+class Symbol {
+ public:
+  struct Entry {
+    std::string name;
+    std::uint32_t id;
+  };
+
+ private:
+  const Entry* entry;
+
+  explicit Symbol(const Entry* entry) : entry(entry) {}
+
+  friend Symbol intern(std::string_view name);
+
+ public:
+  const std::string& name() const { return entry->name; }
+
+  // Dense index assigned in interning order, suitable for table lookups.
+  std::uint32_t id() const { return entry->id; }
+
+  bool operator==(const Symbol& other) const { return entry == other.entry; }
+  bool operator!=(const Symbol& other) const { return entry != other.entry; }
+
+  friend bool operator==(const Symbol& symbol, std::string_view text) {
+    return symbol.name() == text;
+  }
+};
+
+// Returns the unique Symbol for `name`, creating it on first use.
+Symbol intern(std::string_view name);
+
+// The symbols naming the special forms, shared by the Analyzer, the Compiler
+// and the tree-walking Evaluator so that they recognise the same forms.
+inline const Symbol kQuote = intern("quote");
+inline const Symbol kIf = intern("if");
+inline const Symbol kDefine = intern("define");
+inline const Symbol kLambda = intern("lambda");
+
+}  // namespace lisp
+
+template <>
+struct std::hash<lisp::Symbol> {
+  std::size_t operator()(const lisp::Symbol& symbol) const noexcept {
+    return symbol.id();
+  }
+};
@@ -0,0 +1,102 @@
+#include "analyzer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "parser.hpp"
+#include "tokenizer.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+class AnalyzerTest : public ::testing::Test {
+ protected:
+  static ValuePtr analyze_string(const std::string& input) {
+    Tokenizer tokenizer(input);
+    auto tokens = tokenizer.tokenize();
+    Parser parser(tokens);
+    Analyzer analyzer;
+    return analyzer.analyze(parser.parse());
+  }
+
+  // Returns the n-th element of a list.
+  static ValuePtr nth(ValuePtr list, int index) {
+    for (; index > 0; --index) {
+      list = list->cdr();
+    }
+    return list->car();
+  }
+};
+
+TEST_F(AnalyzerTest, AtomsAndGlobalsUnchanged) {
+  EXPECT_TRUE(analyze_string("42")->is_number());
+  EXPECT_TRUE(analyze_string("x")->is_symbol());
+
+  auto result = analyze_string("(+ x 1)");
+  EXPECT_TRUE(nth(result, 0)->is_symbol());
+  EXPECT_TRUE(nth(result, 1)->is_symbol());
+}
+
+TEST_F(AnalyzerTest, ParameterBecomesLocalRef) {
+  auto lambda = analyze_string("(lambda (x y) (+ x y))");
+  auto body = nth(lambda, 2);
+
+  ASSERT_TRUE(nth(body, 0)->is_global_ref());
+  EXPECT_EQ(nth(body, 0)->as_global_ref().name, "+");
+
+  ASSERT_TRUE(nth(body, 1)->is_local_ref());
+  EXPECT_EQ(nth(body, 1)->as_local_ref().name, "x");
+  EXPECT_EQ(nth(body, 1)->as_local_ref().depth, 0);
+  EXPECT_EQ(nth(body, 1)->as_local_ref().slot, 0);
+
+  ASSERT_TRUE(nth(body, 2)->is_local_ref());
+  EXPECT_EQ(nth(body, 2)->as_local_ref().depth, 0);
+  EXPECT_EQ(nth(body, 2)->as_local_ref().slot, 1);
+}
+
+TEST_F(AnalyzerTest, NestedLambdaDepth) {
+  auto outer = analyze_string("(lambda (x) (lambda (y) (+ x y)))");
+  auto body = nth(nth(outer, 2), 2);
+
+  ASSERT_TRUE(nth(body, 1)->is_local_ref());
+  EXPECT_EQ(nth(body, 1)->as_local_ref().depth, 1);
+  EXPECT_EQ(nth(body, 1)->as_local_ref().slot, 0);
+
+  ASSERT_TRUE(nth(body, 2)->is_local_ref());
+  EXPECT_EQ(nth(body, 2)->as_local_ref().depth, 0);
+}
+
+TEST_F(AnalyzerTest, QuotedDataUnchanged) {
+  auto lambda = analyze_string("(lambda (x) '(x))");
+  auto quoted = nth(nth(lambda, 2), 1);
+  EXPECT_TRUE(nth(quoted, 0)->is_symbol());
+}
+
+TEST_F(AnalyzerTest, InternalDefineFallsBackToName) {
+  // The inner define of x shadows the outer parameter, so the reference
+  // inside the inner lambda must be looked up by name.
+  auto lambda =
+      analyze_string("(lambda (x) (lambda (y) (define x y) (+ x y)))");
+  auto inner = nth(lambda, 2);
+  auto define_form = nth(inner, 2);
+  auto sum = nth(inner, 3);
+
+  EXPECT_TRUE(nth(define_form, 1)->is_symbol());
+  EXPECT_TRUE(nth(define_form, 2)->is_local_ref());
+  EXPECT_TRUE(nth(sum, 0)->is_global_ref());
+  EXPECT_TRUE(nth(sum, 1)->is_symbol());
+  EXPECT_TRUE(nth(sum, 2)->is_local_ref());
+}
+
+TEST_F(AnalyzerTest, UnchangedFormIsShared) {
+  Tokenizer tokenizer("(f '(a b) 1)");
+  auto tokens = tokenizer.tokenize();
+  Parser parser(tokens);
+  auto expr = parser.parse();
+
+  Analyzer analyzer;
+  EXPECT_EQ(analyzer.analyze(expr), expr);
+}
+
+}  // namespace lisp
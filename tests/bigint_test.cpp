@@ -0,0 +1,130 @@
+#include "bigint.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace lisp {
+
+namespace {
+
+BigInt parse(const std::string& text) {
+  std::optional<BigInt> const number = BigInt::parse(text);
+  EXPECT_TRUE(number.has_value()) << text;
+  return number.value_or(BigInt());
+}
+
+BigInt factorial(int n) {
+  BigInt result(1);
+  for (int i = 2; i <= n; ++i) {
+    result = result * BigInt(i);
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(BigIntTest, ParseAndPrint) {
+  EXPECT_EQ(parse("0").to_string(), "0");
+  EXPECT_EQ(parse("-0").to_string(), "0");
+  EXPECT_EQ(parse("+42").to_string(), "42");
+  EXPECT_EQ(parse("000123").to_string(), "123");
+
+  std::string const digits = "-123456789012345678901234567890123456789";
+  EXPECT_EQ(parse(digits).to_string(), digits);
+  EXPECT_TRUE(parse(digits).is_negative());
+
+  EXPECT_FALSE(BigInt::parse("").has_value());
+  EXPECT_FALSE(BigInt::parse("-").has_value());
+  EXPECT_FALSE(BigInt::parse("12a").has_value());
+  EXPECT_FALSE(BigInt::parse("1.5").has_value());
+}
+
+TEST(BigIntTest, Int64Conversions) {
+  constexpr std::int64_t kMin = std::numeric_limits<std::int64_t>::min();
+  constexpr std::int64_t kMax = std::numeric_limits<std::int64_t>::max();
+
+  EXPECT_EQ(BigInt(kMin).to_string(), "-9223372036854775808");
+  EXPECT_EQ(BigInt(kMin).to_int64(), kMin);
+  EXPECT_EQ(BigInt(kMax).to_int64(), kMax);
+  EXPECT_EQ(BigInt(0).to_int64(), 0);
+  EXPECT_FALSE((BigInt(kMax) + BigInt(1)).to_int64().has_value());
+  EXPECT_FALSE((BigInt(kMin) - BigInt(1)).to_int64().has_value());
+
+  EXPECT_DOUBLE_EQ(parse("-100000000000000000000").to_double(), -1e20);
+}
+
+TEST(BigIntTest, AddAndSubtractAcrossSigns) {
+  BigInt const large = parse("100000000000000000000");
+  EXPECT_EQ((large + BigInt(-1)).to_string(), "99999999999999999999");
+  EXPECT_EQ((BigInt(1) - large).to_string(), "-99999999999999999999");
+  EXPECT_EQ((-large + large).to_string(), "0");
+  EXPECT_FALSE((-large + large).is_negative());
+  EXPECT_EQ((large + large).to_string(), "200000000000000000000");
+}
+
+TEST(BigIntTest, Compare) {
+  BigInt const large = parse("100000000000000000000");
+  EXPECT_LT(-large, BigInt(-1));
+  EXPECT_LT(BigInt(-1), BigInt(0));
+  EXPECT_LT(BigInt(1), large);
+  EXPECT_GT(large, -large);
+  EXPECT_EQ(large, parse("100000000000000000000"));
+}
+
+TEST(BigIntTest, Multiply) {
+  EXPECT_EQ((parse("-123456789012345678901") * parse("98765432109876543210"))
+                .to_string(),
+            "-12193263113702179522473403443222511812210");
+  EXPECT_EQ((parse("123456789012345678901") * BigInt(0)).to_string(), "0");
+
+  BigInt const f100 = factorial(100);
+  EXPECT_EQ(f100.to_string(),
+            "93326215443944152681699238856266700490715968264381621468592963895"
+            "21759999322991560894146397615651828625369792082722375825118521091"
+            "6864000000000000000000000000");
+}
+
+TEST(BigIntTest, KaratsubaAgreesWithIdentities) {
+  // Operands of hundreds of limbs go through the Karatsuba path.
+  BigInt const a = factorial(1000) + BigInt(12345);
+  BigInt const b = factorial(900) - BigInt(1);
+  BigInt const one(1);
+
+  EXPECT_EQ((a + one) * (a - one), a * a - one);
+  EXPECT_EQ(a * b, b * a);
+  EXPECT_EQ((a + b) * (a + b), a * a + BigInt(2) * a * b + b * b);
+}
+
+TEST(BigIntTest, Divide) {
+  BigInt quotient;
+  BigInt remainder;
+
+  BigInt::divide(BigInt(-7), BigInt(2), quotient, remainder);
+  EXPECT_EQ(quotient, BigInt(-3));
+  EXPECT_EQ(remainder, BigInt(-1));
+
+  BigInt const a = factorial(300);
+  BigInt const b = factorial(120) + BigInt(7);
+  BigInt::divide(a, b, quotient, remainder);
+  EXPECT_EQ(quotient * b + remainder, a);
+  EXPECT_LT(remainder, b);
+  EXPECT_FALSE(remainder.is_negative());
+
+  BigInt::divide(a, factorial(299), quotient, remainder);
+  EXPECT_EQ(quotient, BigInt(300));
+  EXPECT_TRUE(remainder.is_zero());
+
+  BigInt::divide(BigInt(5), a, quotient, remainder);
+  EXPECT_TRUE(quotient.is_zero());
+  EXPECT_EQ(remainder, BigInt(5));
+
+  EXPECT_THROW(BigInt::divide(a, BigInt(0), quotient, remainder),
+               std::domain_error);
+}
+
+}  // namespace lisp
@@ -0,0 +1,101 @@
+#include "compiler.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "analyzer.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+class CompilerTest : public ::testing::Test {
+ protected:
+  static std::shared_ptr<const Chunk> compile_string(
+      const std::string& input) {
+    Tokenizer tokenizer(input);
+    auto tokens = tokenizer.tokenize();
+    Parser parser(tokens);
+    Analyzer analyzer;
+    return Compiler::compile(analyzer.analyze(parser.parse()));
+  }
+
+  static std::vector<OpCode> ops(const Chunk& chunk) {
+    std::vector<OpCode> result;
+    for (const Instruction& instruction : chunk.code) {
+      result.push_back(instruction.op);
+    }
+    return result;
+  }
+};
+
+TEST_F(CompilerTest, Constants) {
+  auto chunk = compile_string("42");
+  EXPECT_EQ(ops(*chunk),
+            (std::vector<OpCode>{OpCode::CONSTANT, OpCode::RETURN}));
+  ASSERT_EQ(chunk->constants.size(), 1U);
+  EXPECT_DOUBLE_EQ(chunk->constants[0]->as_number(), 42.0);
+
+  chunk = compile_string("'(1 2)");
+  EXPECT_EQ(ops(*chunk),
+            (std::vector<OpCode>{OpCode::CONSTANT, OpCode::RETURN}));
+  EXPECT_TRUE(chunk->constants[0]->is_cons());
+}
+
+TEST_F(CompilerTest, CallInTailPosition) {
+  auto chunk = compile_string("(+ x 1)");
+  EXPECT_EQ(ops(*chunk),
+            (std::vector<OpCode>{OpCode::LOAD_NAME, OpCode::LOAD_NAME,
+                                 OpCode::CONSTANT, OpCode::TAIL_CALL,
+                                 OpCode::RETURN}));
+  EXPECT_EQ(chunk->code[3].a, 2U);
+  EXPECT_EQ(chunk->names[0], "+");
+  EXPECT_EQ(chunk->names[1], "x");
+}
+
+TEST_F(CompilerTest, IfJumpsOverBranches) {
+  auto chunk = compile_string("(if c 1)");
+  EXPECT_EQ(ops(*chunk),
+            (std::vector<OpCode>{OpCode::LOAD_NAME, OpCode::JUMP_IF_NIL,
+                                 OpCode::CONSTANT, OpCode::JUMP,
+                                 OpCode::CONSTANT, OpCode::RETURN}));
+  EXPECT_EQ(chunk->code[1].a, 4U);
+  EXPECT_EQ(chunk->code[3].a, 5U);
+  EXPECT_TRUE(chunk->constants[1]->is_nil());
+}
+
+TEST_F(CompilerTest, LambdaBodyIsCompiledAhead) {
+  auto chunk = compile_string("(lambda (x y) (print x) (f y))");
+  EXPECT_EQ(ops(*chunk),
+            (std::vector<OpCode>{OpCode::MAKE_LAMBDA, OpCode::RETURN}));
+  ASSERT_EQ(chunk->lambdas.size(), 1U);
+
+  const LambdaTemplate& lambda = chunk->lambdas[0];
+  EXPECT_EQ(lambda.params.size(), 2U);
+  EXPECT_EQ(lambda.body.size(), 2U);
+  EXPECT_EQ(ops(*lambda.code),
+            (std::vector<OpCode>{OpCode::LOAD_GLOBAL, OpCode::LOAD_LOCAL,
+                                 OpCode::CALL, OpCode::POP,
+                                 OpCode::LOAD_GLOBAL, OpCode::LOAD_LOCAL,
+                                 OpCode::TAIL_CALL, OpCode::RETURN}));
+  EXPECT_EQ(lambda.code->code[5].b, 1U);
+}
+
+TEST_F(CompilerTest, MalformedFormsRaise) {
+  auto chunk = compile_string("(define 42 1)");
+  EXPECT_EQ(ops(*chunk), (std::vector<OpCode>{OpCode::RAISE, OpCode::RETURN}));
+  EXPECT_EQ(chunk->errors[0], "define requires a symbol as first argument");
+
+  // Arguments before the malformed form are still evaluated first.
+  chunk = compile_string("(f (g) (if))");
+  EXPECT_EQ(ops(*chunk),
+            (std::vector<OpCode>{OpCode::LOAD_NAME, OpCode::LOAD_NAME,
+                                 OpCode::CALL, OpCode::RAISE,
+                                 OpCode::TAIL_CALL, OpCode::RETURN}));
+}
+
+}  // namespace lisp
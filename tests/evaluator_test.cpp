@@ -8,14 +8,16 @@
 #include <string>
 
 #include "parser.hpp"
+#include "temp_file.hpp"
 #include "tokenizer.hpp"
 #include "value.hpp"
 
 namespace lisp {
 
-class EvaluatorTest : public ::testing::Test {
+// Every test runs against both engines, which must agree.
+class EvaluatorTest : public ::testing::TestWithParam<Evaluator::Engine> {
  protected:
-  void SetUp() override { evaluator = std::make_unique<Evaluator>(); }
+  void SetUp() override { evaluator = std::make_unique<Evaluator>(GetParam()); }
 
   ValuePtr eval_string(std::string const& input) {
     Tokenizer tokenizer(input);
@@ -29,7 +31,7 @@ class EvaluatorTest : public ::testing::Test {
   std::unique_ptr<Evaluator> evaluator;
 };
 
-TEST_F(EvaluatorTest, SelfEvaluatingExpressions) {
+TEST_P(EvaluatorTest, SelfEvaluatingExpressions) {
   auto result = eval_string("42");
   EXPECT_TRUE(result->is_number());
   EXPECT_DOUBLE_EQ(result->as_number(), 42.0);
@@ -46,7 +48,7 @@ TEST_F(EvaluatorTest, SelfEvaluatingExpressions) {
   EXPECT_TRUE(result->is_nil());
 }
 
-TEST_F(EvaluatorTest, ArithmeticOperations) {
+TEST_P(EvaluatorTest, ArithmeticOperations) {
   auto result = eval_string("(+ 1 2 3)");
   EXPECT_TRUE(result->is_number());
   EXPECT_DOUBLE_EQ(result->as_number(), 6.0);
@@ -64,7 +66,7 @@ TEST_F(EvaluatorTest, ArithmeticOperations) {
   EXPECT_DOUBLE_EQ(result->as_number(), 4.0);
 }
 
-TEST_F(EvaluatorTest, ArithmeticEdgeCases) {
+TEST_P(EvaluatorTest, ArithmeticEdgeCases) {
   auto result = eval_string("(+)");
   EXPECT_TRUE(result->is_number());
   EXPECT_DOUBLE_EQ(result->as_number(), 0.0);
@@ -79,7 +81,90 @@ TEST_F(EvaluatorTest, ArithmeticEdgeCases) {
   EXPECT_THROW(eval_string("(/ 1 0)"), EvalError);
 }
 
-TEST_F(EvaluatorTest, ListOperations) {
+TEST_P(EvaluatorTest, IntegerArithmeticIsExact) {
+  auto result = eval_string("(* 3 (+ 4 5) (- 10 20))");
+  ASSERT_TRUE(result->is_integer());
+  EXPECT_EQ(result->as_integer(), -270);
+
+  // Beyond 2^53, where a double can no longer count by one.
+  result = eval_string("(+ 9007199254740992 1)");
+  ASSERT_TRUE(result->is_integer());
+  EXPECT_EQ(result->as_integer(), 9007199254740993);
+  EXPECT_EQ(result->to_string(), "9007199254740993");
+
+  result = eval_string("(/ 12 4)");
+  ASSERT_TRUE(result->is_integer());
+  EXPECT_EQ(result->as_integer(), 3);
+
+  result = eval_string("(/ 7 2)");
+  EXPECT_FALSE(result->is_integer());
+  EXPECT_DOUBLE_EQ(result->as_number(), 3.5);
+
+  result = eval_string("(+ 1 2.5)");
+  EXPECT_FALSE(result->is_integer());
+  EXPECT_DOUBLE_EQ(result->as_number(), 3.5);
+
+  EXPECT_EQ(eval_string("(= 1 1.0)")->as_symbol(), "#t");
+  EXPECT_EQ(eval_string("(< 9007199254740992 9007199254740993)")->as_symbol(),
+            "#t");
+}
+
+TEST_P(EvaluatorTest, IntegerOverflowPromotesToBignum) {
+  auto result = eval_string("(+ 9223372036854775807 1)");
+  ASSERT_TRUE(result->is_bignum());
+  EXPECT_EQ(result->to_string(), "9223372036854775808");
+
+  result = eval_string("(* 4294967296 4294967296 2)");
+  ASSERT_TRUE(result->is_bignum());
+  EXPECT_EQ(result->to_string(), "36893488147419103232");
+
+  result = eval_string("(- -9223372036854775807 2)");
+  EXPECT_EQ(result->to_string(), "-9223372036854775809");
+
+  result = eval_string("(/ (- -9223372036854775807 1) -1)");
+  EXPECT_EQ(result->to_string(), "9223372036854775808");
+
+  // Results that fit again are demoted to int64_t.
+  result = eval_string("(- (+ 9223372036854775807 10) 20)");
+  ASSERT_TRUE(result->is_integer());
+  EXPECT_EQ(result->as_integer(), 9223372036854775797);
+
+  result = eval_string("(/ 36893488147419103232 4294967296)");
+  ASSERT_TRUE(result->is_integer());
+  EXPECT_EQ(result->as_integer(), 8589934592);
+
+  result = eval_string("(/ 36893488147419103233 2)");
+  EXPECT_FALSE(result->is_integer() || result->is_bignum());
+  EXPECT_DOUBLE_EQ(result->as_number(), 18446744073709551616.5);
+
+  result = eval_string("(+ 36893488147419103232 0.5)");
+  EXPECT_FALSE(result->is_bignum());
+
+  EXPECT_EQ(eval_string("(= 36893488147419103232 36893488147419103232)")
+                ->as_symbol(),
+            "#t");
+  EXPECT_TRUE(
+      eval_string("(= 36893488147419103232 36893488147419103233)")->is_nil());
+  EXPECT_EQ(eval_string("(< 36893488147419103232 36893488147419103233)")
+                ->as_symbol(),
+            "#t");
+  EXPECT_EQ(eval_string("(> 36893488147419103232 5)")->as_symbol(), "#t");
+}
+
+TEST_P(EvaluatorTest, LargeFactorialIsExact) {
+  eval_string(
+      "(define fact (lambda (n acc) (if (= n 0) acc (fact (- n 1) (* n "
+      "acc)))))");
+  auto result = eval_string("(fact 25 1)");
+  EXPECT_EQ(result->to_string(), "15511210043330985984000000");
+
+  result = eval_string("(fact 3000 1)");
+  std::string const digits = result->to_string();
+  EXPECT_EQ(digits.size(), 9131U);
+  EXPECT_EQ(digits.substr(0, 12), "414935960343");
+}
+
+TEST_P(EvaluatorTest, ListOperations) {
   auto result = eval_string("(car '(1 2 3))");
   EXPECT_TRUE(result->is_number());
   EXPECT_DOUBLE_EQ(result->as_number(), 1.0);
@@ -102,7 +187,175 @@ TEST_F(EvaluatorTest, ListOperations) {
   EXPECT_DOUBLE_EQ(result->cdr()->car()->as_number(), 2.0);
 }
 
-TEST_F(EvaluatorTest, ListOperationsOnNil) {
+TEST_P(EvaluatorTest, VectorOperations) {
+  eval_string("(define v (make-vector 3 0))");
+  EXPECT_EQ(eval_string("v")->to_string(), "#(0 0 0)");
+  EXPECT_EQ(eval_string("(vector-length v)")->as_integer(), 3);
+
+  eval_string("(vector-set! v 1 'x)");
+  EXPECT_EQ(eval_string("(vector-ref v 1)")->as_symbol(), "x");
+  EXPECT_EQ(eval_string("v")->to_string(), "#(0 x 0)");
+
+  EXPECT_EQ(eval_string("(make-vector 2)")->to_string(), "#(nil nil)");
+  EXPECT_EQ(eval_string("(vector 1 (+ 1 1) \"three\")")->to_string(),
+            "#(1 2 \"three\")");
+  EXPECT_EQ(eval_string("#(1 (+ 1 1))")->to_string(), "#(1 (+ 1 1))");
+  EXPECT_EQ(eval_string("(vector? #())")->as_symbol(), "#t");
+  EXPECT_TRUE(eval_string("(vector? '(1))")->is_nil());
+
+  // Vectors are shared, not copied, when passed around.
+  eval_string("(define fill (lambda (vec i) (vector-set! vec i i)))");
+  eval_string("(fill v 2)");
+  EXPECT_EQ(eval_string("(vector-ref v 2)")->as_integer(), 2);
+}
+
+TEST_P(EvaluatorTest, VectorErrors) {
+  eval_string("(define v (vector 1 2))");
+  EXPECT_THROW(eval_string("(vector-ref v 2)"), EvalError);
+  EXPECT_THROW(eval_string("(vector-ref v -1)"), EvalError);
+  EXPECT_THROW(eval_string("(vector-ref v 0.5)"), EvalError);
+  EXPECT_THROW(eval_string("(vector-ref '(1 2) 0)"), EvalError);
+  EXPECT_THROW(eval_string("(vector-set! v 5 0)"), EvalError);
+  EXPECT_THROW(eval_string("(vector-length 1)"), EvalError);
+  EXPECT_THROW(eval_string("(make-vector -1)"), EvalError);
+  EXPECT_THROW(eval_string("(make-vector)"), EvalError);
+  EXPECT_THROW(eval_string("(make-vector 1 2 3)"), EvalError);
+}
+
+TEST_P(EvaluatorTest, F64ArrayOperations) {
+  eval_string("(define a (f64array 1 2 3 4 5))");
+  eval_string("(define b (list->f64array '(10 20 30 40 50)))");
+  EXPECT_EQ(eval_string("(f64array-length a)")->as_integer(), 5);
+  EXPECT_DOUBLE_EQ(eval_string("(f64array-ref b 4)")->as_number(), 50.0);
+
+  EXPECT_EQ(eval_string("(f64array-add a b)")->to_string(),
+            "#f64(11 22 33 44 55)");
+  EXPECT_EQ(eval_string("(f64array-mul a a)")->to_string(),
+            "#f64(1 4 9 16 25)");
+  EXPECT_EQ(eval_string("(f64array-scale a 0.5)")->to_string(),
+            "#f64(0.500000 1 1.500000 2 2.500000)");
+  EXPECT_DOUBLE_EQ(eval_string("(f64array-dot a b)")->as_number(), 550.0);
+  EXPECT_DOUBLE_EQ(eval_string("(f64array-sum b)")->as_number(), 150.0);
+
+  eval_string("(f64array-set! a 2 -7)");
+  EXPECT_DOUBLE_EQ(eval_string("(f64array-min a)")->as_number(), -7.0);
+  EXPECT_DOUBLE_EQ(eval_string("(f64array-max a)")->as_number(), 5.0);
+
+  EXPECT_EQ(eval_string("(make-f64array 3 2)")->to_string(), "#f64(2 2 2)");
+  EXPECT_EQ(eval_string("(make-f64array 2)")->to_string(), "#f64(0 0)");
+  EXPECT_EQ(eval_string("(f64array? a)")->as_symbol(), "#t");
+  EXPECT_TRUE(eval_string("(f64array? (vector 1))")->is_nil());
+}
+
+TEST_P(EvaluatorTest, F64ArrayErrors) {
+  eval_string("(define a (f64array 1 2))");
+  EXPECT_THROW(eval_string("(f64array 1 'x)"), EvalError);
+  EXPECT_THROW(eval_string("(list->f64array '(1 \"2\"))"), EvalError);
+  EXPECT_THROW(eval_string("(f64array-ref a 2)"), EvalError);
+  EXPECT_THROW(eval_string("(f64array-set! a 0 'x)"), EvalError);
+  EXPECT_THROW(eval_string("(f64array-add a (f64array 1))"), EvalError);
+  EXPECT_THROW(eval_string("(f64array-dot a (vector 1 2))"), EvalError);
+  EXPECT_THROW(eval_string("(f64array-min (f64array))"), EvalError);
+  EXPECT_THROW(eval_string("(make-f64array -1)"), EvalError);
+}
+
+TEST_P(EvaluatorTest, HashTableOperations) {
+  eval_string("(define table (make-hash-table))");
+  EXPECT_EQ(eval_string("(hash-table? table)")->as_symbol(), "#t");
+  EXPECT_TRUE(eval_string("(hash-table? '(a . 1))")->is_nil());
+
+  eval_string("(hash-table-put! table 'host \"example.org\")");
+  eval_string("(hash-table-put! table \"port\" 80)");
+  eval_string("(hash-table-put! table 1 'one)");
+  EXPECT_EQ(eval_string("(hash-table-get table 'host)")->as_string(),
+            "example.org");
+  EXPECT_EQ(eval_string("(hash-table-get table \"port\")")->as_integer(), 80);
+  EXPECT_EQ(eval_string("(hash-table-get table 1.0)")->as_symbol(), "one");
+  EXPECT_TRUE(eval_string("(hash-table-get table 'missing)")->is_nil());
+  EXPECT_EQ(eval_string("(hash-table-get table 'missing 5)")->as_integer(), 5);
+  EXPECT_EQ(eval_string("(hash-table-count table)")->as_integer(), 3);
+
+  eval_string("(hash-table-put! table \"port\" 8080)");
+  EXPECT_EQ(eval_string("(hash-table-get table \"port\")")->as_integer(),
+            8080);
+  EXPECT_EQ(eval_string("(hash-table-delete! table 1)")->as_symbol(), "#t");
+  EXPECT_TRUE(eval_string("(hash-table-delete! table 1)")->is_nil());
+  EXPECT_TRUE(eval_string("(hash-table-contains? table 1)")->is_nil());
+  EXPECT_EQ(eval_string("(hash-table-contains? table 'host)")->as_symbol(),
+            "#t");
+
+  eval_string("(define small (make-hash-table))");
+  eval_string("(hash-table-put! small 'k 'v)");
+  EXPECT_EQ(eval_string("(hash-table-keys small)")->to_string(), "(k)");
+  EXPECT_EQ(eval_string("(hash-table->alist small)")->to_string(),
+            "((k . v))");
+}
+
+TEST_P(EvaluatorTest, HashTableScalesToManyKeys) {
+  eval_string("(define table (make-hash-table))");
+  eval_string(R"(
+    (define fill
+      (lambda (i n)
+        (if (< i n)
+            ((lambda ()
+               (hash-table-put! table i (* i i))
+               (fill (+ i 1) n))))))
+  )");
+  eval_string("(fill 0 20000)");
+  EXPECT_EQ(eval_string("(hash-table-count table)")->as_integer(), 20000);
+  EXPECT_EQ(eval_string("(hash-table-get table 12345)")->as_integer(),
+            12345LL * 12345);
+}
+
+TEST_P(EvaluatorTest, HashTableErrors) {
+  eval_string("(define table (make-hash-table))");
+  EXPECT_THROW(eval_string("(hash-table-put! table '(1) 2)"), EvalError);
+  EXPECT_THROW(eval_string("(hash-table-get table nil)"), EvalError);
+  EXPECT_THROW(eval_string("(hash-table-get table)"), EvalError);
+  EXPECT_THROW(eval_string("(hash-table-count '())"), EvalError);
+  EXPECT_THROW(eval_string("(hash-table-put! (vector) 1 2)"), EvalError);
+}
+
+TEST_P(EvaluatorTest, StringOperations) {
+  eval_string("(define line \"2026-10-16 WARN disk nearly full\")");
+  EXPECT_EQ(eval_string("(string-length line)")->as_integer(), 32);
+  EXPECT_EQ(eval_string("(substring line 11 15)")->as_string(), "WARN");
+  EXPECT_EQ(eval_string("(substring line 16)")->as_string(),
+            "disk nearly full");
+  EXPECT_EQ(eval_string("(substring line 32)")->as_string(), "");
+
+  EXPECT_EQ(eval_string("(string-append)")->as_string(), "");
+  EXPECT_EQ(eval_string("(string-append \"a\" \"\" \"bc\")")->as_string(),
+            "abc");
+  EXPECT_EQ(eval_string("(string-append (substring line 0 4) \"!\")")
+                ->to_string(),
+            "\"2026!\"");
+
+  eval_string(R"(
+    (define repeat
+      (lambda (text n)
+        (if (= n 0)
+            text
+            (repeat (string-append text line) (- n 1)))))
+  )");
+  EXPECT_EQ(eval_string("(string-length (repeat \"\" 1000))")->as_integer(),
+            32000);
+  EXPECT_EQ(
+      eval_string("(substring (repeat \"\" 1000) 31991 32000)")->as_string(),
+      "arly full");
+}
+
+TEST_P(EvaluatorTest, StringErrors) {
+  EXPECT_THROW(eval_string("(string-append \"a\" 'b)"), EvalError);
+  EXPECT_THROW(eval_string("(string-length 'abc)"), EvalError);
+  EXPECT_THROW(eval_string("(substring \"abc\" 4)"), EvalError);
+  EXPECT_THROW(eval_string("(substring \"abc\" 2 1)"), EvalError);
+  EXPECT_THROW(eval_string("(substring \"abc\" -1)"), EvalError);
+  EXPECT_THROW(eval_string("(substring \"abc\" 1.0)"), EvalError);
+  EXPECT_THROW(eval_string("(substring \"abc\")"), EvalError);
+}
+
+TEST_P(EvaluatorTest, ListOperationsOnNil) {
   auto result = eval_string("(car nil)");
   EXPECT_TRUE(result->is_nil());
 
@@ -116,7 +369,7 @@ TEST_F(EvaluatorTest, ListOperationsOnNil) {
   EXPECT_TRUE(result->is_nil());
 }
 
-TEST_F(EvaluatorTest, ComparisonOperations) {
+TEST_P(EvaluatorTest, ComparisonOperations) {
   auto result = eval_string("(= 1 1)");
   EXPECT_TRUE(result->is_symbol());
   EXPECT_EQ(result->as_symbol(), "#t");
@@ -139,7 +392,16 @@ TEST_F(EvaluatorTest, ComparisonOperations) {
   EXPECT_TRUE(result->is_nil());
 }
 
-TEST_F(EvaluatorTest, StringAndSymbolComparisons) {
+TEST_P(EvaluatorTest, PredicatesReturnSharedConstants) {
+  EXPECT_EQ(eval_string("(< 1 2)"), make_true());
+  EXPECT_EQ(eval_string("(number? 1)"), make_true());
+  EXPECT_EQ(eval_string("#t"), make_true());
+  EXPECT_EQ(eval_string("#f"), make_false());
+  EXPECT_EQ(eval_string("(> 1 2)"), make_nil());
+  EXPECT_EQ(eval_string("(cdr '(1))"), make_nil());
+}
+
+TEST_P(EvaluatorTest, StringAndSymbolComparisons) {
   auto result = eval_string("(= \"hello\" \"hello\")");
   EXPECT_TRUE(result->is_symbol());
   EXPECT_EQ(result->as_symbol(), "#t");
@@ -159,7 +421,7 @@ TEST_F(EvaluatorTest, StringAndSymbolComparisons) {
   EXPECT_EQ(result->as_symbol(), "#t");
 }
 
-TEST_F(EvaluatorTest, TypePredicates) {
+TEST_P(EvaluatorTest, TypePredicates) {
   auto result = eval_string("(null? nil)");
   EXPECT_TRUE(result->is_symbol());
   EXPECT_EQ(result->as_symbol(), "#t");
@@ -196,7 +458,7 @@ TEST_F(EvaluatorTest, TypePredicates) {
   EXPECT_TRUE(result->is_nil());
 }
 
-TEST_F(EvaluatorTest, QuoteSpecialForm) {
+TEST_P(EvaluatorTest, QuoteSpecialForm) {
   auto result = eval_string("'hello");
   EXPECT_TRUE(result->is_symbol());
   EXPECT_EQ(result->as_symbol(), "hello");
@@ -216,7 +478,7 @@ TEST_F(EvaluatorTest, QuoteSpecialForm) {
   EXPECT_EQ(result->car()->as_symbol(), "+");
 }
 
-TEST_F(EvaluatorTest, IfSpecialForm) {
+TEST_P(EvaluatorTest, IfSpecialForm) {
   auto result = eval_string("(if #t 1 2)");
   EXPECT_TRUE(result->is_number());
   EXPECT_DOUBLE_EQ(result->as_number(), 1.0);
@@ -241,7 +503,7 @@ TEST_F(EvaluatorTest, IfSpecialForm) {
   EXPECT_TRUE(result->is_nil());
 }
 
-TEST_F(EvaluatorTest, DefineSpecialForm) {
+TEST_P(EvaluatorTest, DefineSpecialForm) {
   eval_string("(define x 42)");
   auto result = eval_string("x");
   EXPECT_TRUE(result->is_number());
@@ -258,7 +520,7 @@ TEST_F(EvaluatorTest, DefineSpecialForm) {
   EXPECT_EQ(result->as_string(), "hello world");
 }
 
-TEST_F(EvaluatorTest, LambdaSpecialForm) {
+TEST_P(EvaluatorTest, LambdaSpecialForm) {
   auto result = eval_string("((lambda (x) (+ x 1)) 5)");
   EXPECT_TRUE(result->is_number());
   EXPECT_DOUBLE_EQ(result->as_number(), 6.0);
@@ -277,7 +539,7 @@ TEST_F(EvaluatorTest, LambdaSpecialForm) {
   EXPECT_DOUBLE_EQ(result->as_number(), 25.0);
 }
 
-TEST_F(EvaluatorTest, LexicalScoping) {
+TEST_P(EvaluatorTest, LexicalScoping) {
   eval_string("(define x 10)");
   eval_string("(define f (lambda (y) (+ x y)))");
   auto result = eval_string("(f 5)");
@@ -289,7 +551,7 @@ TEST_F(EvaluatorTest, LexicalScoping) {
   EXPECT_DOUBLE_EQ(result->as_number(), 50.0);
 }
 
-TEST_F(EvaluatorTest, ComplexExpressions) {
+TEST_P(EvaluatorTest, ComplexExpressions) {
   auto result = eval_string("(+ (* 2 3) (/ 8 2))");
   EXPECT_TRUE(result->is_number());
   EXPECT_DOUBLE_EQ(result->as_number(), 10.0);
@@ -304,7 +566,7 @@ TEST_F(EvaluatorTest, ComplexExpressions) {
   EXPECT_DOUBLE_EQ(result->car()->as_number(), 3.0);
 }
 
-TEST_F(EvaluatorTest, FactorialExample) {
+TEST_P(EvaluatorTest, FactorialExample) {
   std::string const factorial_def = R"(
         (define factorial
           (lambda (n)
@@ -328,7 +590,7 @@ TEST_F(EvaluatorTest, FactorialExample) {
   EXPECT_DOUBLE_EQ(result->as_number(), 120.0);
 }
 
-TEST_F(EvaluatorTest, ErrorConditions) {
+TEST_P(EvaluatorTest, ErrorConditions) {
   EXPECT_THROW(eval_string("undefined_symbol"), EvalError);
   EXPECT_THROW(eval_string("(+ 1 \"hello\")"), EvalError);
   EXPECT_THROW(eval_string("(car 42)"), EvalError);
@@ -340,7 +602,7 @@ TEST_F(EvaluatorTest, ErrorConditions) {
   EXPECT_THROW(eval_string("((lambda (x) x) 1 2)"), EvalError);
 }
 
-TEST_F(EvaluatorTest, ArgumentCountErrors) {
+TEST_P(EvaluatorTest, ArgumentCountErrors) {
   EXPECT_THROW(eval_string("(car)"), EvalError);
   EXPECT_THROW(eval_string("(car 1 2)"), EvalError);
   EXPECT_THROW(eval_string("(cdr)"), EvalError);
@@ -355,7 +617,46 @@ TEST_F(EvaluatorTest, ArgumentCountErrors) {
   EXPECT_THROW(eval_string("(null? 1 2)"), EvalError);
 }
 
-TEST_F(EvaluatorTest, SpecialFormErrors) {
+TEST_P(EvaluatorTest, FixedArityBuiltinsEvaluateEveryArgument) {
+  eval_string("(define n 0)");
+  EXPECT_THROW(eval_string("(car '(1) (define n 1))"), EvalError);
+  EXPECT_DOUBLE_EQ(eval_string("n")->as_number(), 1.0);
+
+  EXPECT_THROW(eval_string("(null? undefined_symbol)"), EvalError);
+  EXPECT_THROW(eval_string("(newline undefined_symbol)"), EvalError);
+}
+
+TEST_P(EvaluatorTest, ArgumentsOfNestedCalls) {
+  eval_string("(define wide (lambda (a b c d e f) (list a b c d e f)))");
+  EXPECT_EQ(eval_string("(wide 1 2 3 4 5 (+ 1 (* 2 (- 9 6))))")->to_string(),
+            "(1 2 3 4 5 7)");
+  EXPECT_EQ(eval_string("(list 1 (list 2 (wide 3 4 5 6 7 8)) 9)")->to_string(),
+            "(1 (2 (3 4 5 6 7 8)) 9)");
+
+  // A failed call leaves no arguments behind for the next one.
+  EXPECT_THROW(eval_string("(wide 1 2 3 (car 4) 5 6)"), EvalError);
+  EXPECT_THROW(eval_string("(wide 1 2)"), EvalError);
+  EXPECT_DOUBLE_EQ(eval_string("(+ 1 2)")->as_number(), 3.0);
+}
+
+TEST_P(EvaluatorTest, CachedGlobalsSeeRedefinition) {
+  eval_string("(define f (lambda (x) (g x)))");
+  EXPECT_THROW(eval_string("(f 1)"), EvalError);  // g is not yet bound
+
+  eval_string("(define g (lambda (x) (+ x 1)))");
+  EXPECT_DOUBLE_EQ(eval_string("(f 1)")->as_number(), 2.0);
+  EXPECT_DOUBLE_EQ(eval_string("(f 2)")->as_number(), 3.0);
+
+  eval_string("(define g (lambda (x) (* x 10)))");
+  EXPECT_DOUBLE_EQ(eval_string("(f 2)")->as_number(), 20.0);
+
+  // An internal define of the same name shadows the global.
+  eval_string("(define h (lambda (x) (define g (lambda (y) y)) (g x)))");
+  EXPECT_DOUBLE_EQ(eval_string("(h 5)")->as_number(), 5.0);
+  EXPECT_DOUBLE_EQ(eval_string("(f 5)")->as_number(), 50.0);
+}
+
+TEST_P(EvaluatorTest, SpecialFormErrors) {
   EXPECT_THROW(eval_string("(quote)"), EvalError);
   EXPECT_THROW(eval_string("(if)"), EvalError);
   EXPECT_THROW(eval_string("(if #t)"), EvalError);
@@ -365,7 +666,7 @@ TEST_F(EvaluatorTest, SpecialFormErrors) {
   EXPECT_THROW(eval_string("(lambda ())"), EvalError);
 }
 
-TEST_F(EvaluatorTest, NestedEnvironments) {
+TEST_P(EvaluatorTest, NestedEnvironments) {
   eval_string("(define x 100)");
   eval_string("(define outer (lambda (y) (lambda (z) (+ x y z))))");
   eval_string("(define inner (outer 10))");
@@ -374,7 +675,7 @@ TEST_F(EvaluatorTest, NestedEnvironments) {
   EXPECT_DOUBLE_EQ(result->as_number(), 111.0);
 }
 
-TEST_F(EvaluatorTest, CurriedFunctions) {
+TEST_P(EvaluatorTest, CurriedFunctions) {
   eval_string("(define add (lambda (x) (lambda (y) (+ x y))))");
   eval_string("(define add5 (add 5))");
   auto result = eval_string("(add5 10)");
@@ -382,6 +683,52 @@ TEST_F(EvaluatorTest, CurriedFunctions) {
   EXPECT_DOUBLE_EQ(result->as_number(), 15.0);
 }
 
+TEST_P(EvaluatorTest, InternalDefineShadowsParameter) {
+  eval_string(
+      "(define f (lambda (x) (lambda (y) (define x (* y 10)) (+ x y))))");
+  auto result = eval_string("((f 1) 2)");
+  EXPECT_TRUE(result->is_number());
+  EXPECT_DOUBLE_EQ(result->as_number(), 22.0);
+
+  eval_string("(define g (lambda (x) (define x (+ x 1)) x))");
+  result = eval_string("(g 1)");
+  EXPECT_TRUE(result->is_number());
+  EXPECT_DOUBLE_EQ(result->as_number(), 2.0);
+}
+
+TEST_P(EvaluatorTest, ClosureOutlivesLambda) {
+  auto result = eval_string("(((lambda (x) (lambda (y) (+ x y))) 3) 4)");
+  EXPECT_TRUE(result->is_number());
+  EXPECT_DOUBLE_EQ(result->as_number(), 7.0);
+}
+
+TEST_P(EvaluatorTest, TailCallsRunInConstantStack) {
+  eval_string(R"(
+        (define count-down
+          (lambda (n acc)
+            (if (= n 0)
+                acc
+                (count-down (- n 1) (+ acc 1)))))
+    )");
+  auto result = eval_string("(count-down 300000 0)");
+  EXPECT_TRUE(result->is_number());
+  EXPECT_DOUBLE_EQ(result->as_number(), 300000.0);
+
+  // Tail position through nested ifs and multi-expression bodies.
+  eval_string(R"(
+        (define even-odd
+          (lambda (n even)
+            (define next (- n 1))
+            (if (= n 0)
+                even
+                (if even
+                    (even-odd next nil)
+                    (even-odd next #t)))))
+    )");
+  result = eval_string("(even-odd 300001 #t)");
+  EXPECT_TRUE(result->is_nil());
+}
+
 class IOTest : public EvaluatorTest {
  protected:
   void SetUp() override {
@@ -414,7 +761,7 @@ class IOTest : public EvaluatorTest {
   std::streambuf* original_cin = nullptr;
 };
 
-TEST_F(IOTest, PrintFunction) {
+TEST_P(IOTest, PrintFunction) {
   auto result = eval_string("(print \"hello\")");
 
   // Check return value
@@ -426,7 +773,7 @@ TEST_F(IOTest, PrintFunction) {
   EXPECT_EQ(output, "\"hello\"\n");
 }
 
-TEST_F(IOTest, PrintNumbers) {
+TEST_P(IOTest, PrintNumbers) {
   auto result = eval_string("(print 42)");
 
   // Check return value
@@ -438,7 +785,7 @@ TEST_F(IOTest, PrintNumbers) {
   EXPECT_EQ(output, "42\n");
 }
 
-TEST_F(IOTest, PrintNil) {
+TEST_P(IOTest, PrintNil) {
   auto result = eval_string("(print nil)");
 
   // Check return value
@@ -449,7 +796,7 @@ TEST_F(IOTest, PrintNil) {
   EXPECT_EQ(output, "nil\n");
 }
 
-TEST_F(IOTest, DisplayFunction) {
+TEST_P(IOTest, DisplayFunction) {
   auto result = eval_string("(display \"hello\")");
 
   // Check return value
@@ -461,7 +808,7 @@ TEST_F(IOTest, DisplayFunction) {
   EXPECT_EQ(output, "\"hello\"");
 }
 
-TEST_F(IOTest, DisplayNumbers) {
+TEST_P(IOTest, DisplayNumbers) {
   auto result = eval_string("(display 123)");
 
   // Check return value
@@ -473,7 +820,7 @@ TEST_F(IOTest, DisplayNumbers) {
   EXPECT_EQ(output, "123");
 }
 
-TEST_F(IOTest, NewlineFunction) {
+TEST_P(IOTest, NewlineFunction) {
   auto result = eval_string("(newline)");
 
   // Check return value
@@ -484,7 +831,15 @@ TEST_F(IOTest, NewlineFunction) {
   EXPECT_EQ(output, "\n");
 }
 
-TEST_F(IOTest, ReadLineFunction) {
+TEST_P(IOTest, FlushFunction) {
+  eval_string("(display 1)");
+  auto result = eval_string("(flush)");
+
+  EXPECT_TRUE(result->is_nil());
+  EXPECT_EQ(get_output(), "1");
+}
+
+TEST_P(IOTest, ReadLineFunction) {
   set_input("hello world\n");
 
   auto result = eval_string("(read-line)");
@@ -494,7 +849,7 @@ TEST_F(IOTest, ReadLineFunction) {
   EXPECT_EQ(result->as_string(), "hello world");
 }
 
-TEST_F(IOTest, ReadLineEmpty) {
+TEST_P(IOTest, ReadLineEmpty) {
   set_input("\n");
 
   auto result = eval_string("(read-line)");
@@ -504,7 +859,7 @@ TEST_F(IOTest, ReadLineEmpty) {
   EXPECT_EQ(result->as_string(), "");
 }
 
-TEST_F(IOTest, ReadLineEOF) {
+TEST_P(IOTest, ReadLineEOF) {
   set_input("");  // No input, immediate EOF
 
   auto result = eval_string("(read-line)");
@@ -513,7 +868,48 @@ TEST_F(IOTest, ReadLineEOF) {
   EXPECT_TRUE(result->is_nil());
 }
 
-TEST_F(IOTest, CombinedIOOperations) {
+TEST_P(IOTest, ReadCharFunction) {
+  set_input("ab");
+
+  EXPECT_EQ(eval_string("(read-char)")->as_string(), "a");
+  EXPECT_EQ(eval_string("(read-char)")->as_string(), "b");
+  EXPECT_TRUE(eval_string("(read-char)")->is_nil());
+}
+
+TEST_P(IOTest, WriteStringFunction) {
+  auto result = eval_string("(write-string \"a \\\"b\\\"\")");
+
+  // Unlike display, the text is written without quotes.
+  EXPECT_EQ(result->as_string(), "a \"b\"");
+  EXPECT_EQ(get_output(), "a \"b\"");
+}
+
+TEST_P(IOTest, PortsWriteAndReadFiles) {
+  TempFile const file("evaluator_port_test.txt");
+  std::string const& path = file.path();
+  eval_string("(define out (open-output-file \"" + path + "\"))");
+  EXPECT_EQ(eval_string("(port? out)")->as_symbol(), "#t");
+  EXPECT_EQ(eval_string("out")->to_string(), "#<output-port>");
+  eval_string("(write-string \"first line\" out)");
+  eval_string("(write-string \"\nxy\" out)");
+  EXPECT_TRUE(eval_string("(close-port out)")->is_nil());
+  // Closing twice is harmless.
+  EXPECT_TRUE(eval_string("(close-port out)")->is_nil());
+
+  eval_string("(define in (open-input-file \"" + path + "\"))");
+  EXPECT_EQ(eval_string("in")->to_string(), "#<input-port>");
+  EXPECT_EQ(eval_string("(read-line in)")->as_string(), "first line");
+  EXPECT_EQ(eval_string("(read-char in)")->as_string(), "x");
+  EXPECT_EQ(eval_string("(read-line in)")->as_string(), "y");
+  EXPECT_TRUE(eval_string("(read-line in)")->is_nil());
+  EXPECT_TRUE(eval_string("(read-char in)")->is_nil());
+  eval_string("(close-port in)");
+
+  // Nothing was written to standard output.
+  EXPECT_EQ(get_output(), "");
+}
+
+TEST_P(IOTest, CombinedIOOperations) {
   // Test display followed by newline
   eval_string("(display \"Hello\")");
   eval_string("(display \" \")");
@@ -524,7 +920,7 @@ TEST_F(IOTest, CombinedIOOperations) {
   EXPECT_EQ(output, "\"Hello\"\" \"\"World\"\n");
 }
 
-TEST_F(IOTest, PrintInExpressions) {
+TEST_P(IOTest, PrintInExpressions) {
   // Test that print can be used in larger expressions
   auto result = eval_string("(+ (print 5) (print 10))");
 
@@ -537,7 +933,7 @@ TEST_F(IOTest, PrintInExpressions) {
   EXPECT_EQ(output, "5\n10\n");
 }
 
-TEST_F(EvaluatorTest, IOArgumentErrors) {
+TEST_P(EvaluatorTest, IOArgumentErrors) {
   // Test argument count validation
   EXPECT_THROW(eval_string("(print)"), EvalError);
   EXPECT_THROW(eval_string("(print 1 2)"), EvalError);
@@ -545,6 +941,46 @@ TEST_F(EvaluatorTest, IOArgumentErrors) {
   EXPECT_THROW(eval_string("(display 1 2)"), EvalError);
   EXPECT_THROW(eval_string("(newline 1)"), EvalError);
   EXPECT_THROW(eval_string("(read-line 1)"), EvalError);
-}
+  EXPECT_THROW(eval_string("(read-char 1)"), EvalError);
+  EXPECT_THROW(eval_string("(write-string)"), EvalError);
+  EXPECT_THROW(eval_string("(write-string 1)"), EvalError);
+}
+
+TEST_P(EvaluatorTest, PortErrors) {
+  TempFile const file("evaluator_port_errors.txt");
+  std::string const& path = file.path();
+  EXPECT_THROW(eval_string("(open-input-file \"" + path + ".missing\")"),
+               EvalError);
+  EXPECT_THROW(eval_string("(open-input-file 1)"), EvalError);
+  EXPECT_THROW(eval_string("(close-port 1)"), EvalError);
+  EXPECT_TRUE(eval_string("(port? \"file\")")->is_nil());
+
+  eval_string("(define out (open-output-file \"" + path + "\"))");
+  // An output port cannot be read, nor an input port written.
+  EXPECT_THROW(eval_string("(read-line out)"), EvalError);
+  EXPECT_THROW(eval_string("(read-char out)"), EvalError);
+  eval_string("(close-port out)");
+  eval_string("(define in (open-input-file \"" + path + "\"))");
+  EXPECT_THROW(eval_string("(write-string \"x\" in)"), EvalError);
+  // A closed port cannot be used.
+  eval_string("(close-port in)");
+  EXPECT_THROW(eval_string("(read-line in)"), EvalError);
+  EXPECT_THROW(eval_string("(write-string \"x\" out)"), EvalError);
+}
+
+std::string engine_name(
+    const ::testing::TestParamInfo<Evaluator::Engine>& info) {
+  return info.param == Evaluator::Engine::BYTECODE ? "Bytecode" : "TreeWalker";
+}
+
+INSTANTIATE_TEST_SUITE_P(Engines, EvaluatorTest,
+                         ::testing::Values(Evaluator::Engine::TREE_WALKER,
+                                           Evaluator::Engine::BYTECODE),
+                         engine_name);
+
+INSTANTIATE_TEST_SUITE_P(Engines, IOTest,
+                         ::testing::Values(Evaluator::Engine::TREE_WALKER,
+                                           Evaluator::Engine::BYTECODE),
+                         engine_name);
 
 }  // namespace lisp
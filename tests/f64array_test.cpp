@@ -0,0 +1,110 @@
+#include "f64array.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace lisp {
+
+namespace {
+
+// Sizes around the vector and unrolled block widths, so that every kernel
+// is checked with and without a scalar tail.
+constexpr std::size_t kSizes[] = {0, 1, 2, 3, 7, 8, 9, 16, 17, 1001};
+
+F64Array iota(std::size_t size, double start) {
+  F64Array array(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    array[i] = start + static_cast<double>(i);
+  }
+  return array;
+}
+
+}  // namespace
+
+TEST(F64ArrayTest, StorageIsAlignedAndFilled) {
+  F64Array const array(100, 2.5);
+  ASSERT_EQ(array.size(), 100);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(array.data()) %
+                F64Array::kAlignment,
+            0);
+  for (double const element : array.span()) {
+    EXPECT_EQ(element, 2.5);
+  }
+
+  F64Array const empty;
+  EXPECT_EQ(empty.size(), 0);
+  EXPECT_TRUE(empty.span().empty());
+}
+
+TEST(F64ArrayTest, ElementWiseKernels) {
+  for (std::size_t const size : kSizes) {
+    F64Array const lhs = iota(size, 1);
+    F64Array const rhs = iota(size, 100);
+    F64Array sum(size);
+    F64Array product(size);
+    F64Array scaled(size);
+    f64_add(lhs.span(), rhs.span(), sum.span());
+    f64_multiply(lhs.span(), rhs.span(), product.span());
+    f64_scale(lhs.span(), -0.5, scaled.span());
+    for (std::size_t i = 0; i < size; ++i) {
+      EXPECT_EQ(sum[i], lhs[i] + rhs[i]) << size;
+      EXPECT_EQ(product[i], lhs[i] * rhs[i]) << size;
+      EXPECT_EQ(scaled[i], lhs[i] * -0.5) << size;
+    }
+  }
+}
+
+TEST(F64ArrayTest, KernelsMayWriteInPlace) {
+  F64Array array = iota(9, 1);
+  f64_add(array.span(), array.span(), array.span());
+  f64_scale(array.span(), 0.5, array.span());
+  for (std::size_t i = 0; i < array.size(); ++i) {
+    EXPECT_EQ(array[i], static_cast<double>(i + 1));
+  }
+}
+
+TEST(F64ArrayTest, Reductions) {
+  for (std::size_t const size : kSizes) {
+    F64Array const values = iota(size, 1);
+    double const n = static_cast<double>(size);
+    // Small integers, so every partial sum is exact in any order.
+    EXPECT_EQ(f64_sum(values.span()), n * (n + 1) / 2) << size;
+    EXPECT_EQ(f64_dot(values.span(), values.span()),
+              n * (n + 1) * (2 * n + 1) / 6)
+        << size;
+    if (size > 0) {
+      EXPECT_EQ(f64_min(values.span()), 1) << size;
+      EXPECT_EQ(f64_max(values.span()), n) << size;
+    }
+  }
+}
+
+TEST(F64ArrayTest, MinAndMaxFindEveryPosition) {
+  for (std::size_t at = 0; at < 11; ++at) {
+    F64Array values(11, 0.0);
+    values[at] = -3;
+    EXPECT_EQ(f64_min(values.span()), -3) << at;
+    values[at] = 3;
+    EXPECT_EQ(f64_max(values.span()), 3) << at;
+  }
+}
+
+TEST(F64ArrayTest, MinAndMaxIgnoreNaN) {
+  double const nan = std::numeric_limits<double>::quiet_NaN();
+  F64Array values(5, nan);
+  values[3] = 4;
+  values[4] = -2;
+  EXPECT_EQ(f64_min(values.span()), -2);
+  EXPECT_EQ(f64_max(values.span()), 4);
+
+  F64Array const empty;
+  EXPECT_EQ(f64_min(empty.span()), std::numeric_limits<double>::infinity());
+  EXPECT_EQ(f64_max(empty.span()), -std::numeric_limits<double>::infinity());
+  EXPECT_TRUE(std::isnan(f64_sum(F64Array(3, nan).span())));
+}
+
+}  // namespace lisp
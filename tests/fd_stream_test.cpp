@@ -0,0 +1,83 @@
+#include "fd_stream.hpp"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "temp_file.hpp"
+
+namespace lisp {
+
+TEST(FdStreamTest, OutputIsBufferedUntilFlushed) {
+  TempFile const file("fd_stream_test.txt");
+  int const fd =
+      ::open(file.path().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  ASSERT_GE(fd, 0);
+  {
+    FdOutputBuffer buffer(fd);
+    std::ostream out(&buffer);
+    out << "hello " << 42 << '\n';
+    EXPECT_EQ(file.read(), "");
+    out.flush();
+    EXPECT_EQ(file.read(), "hello 42\n");
+    out << "unflushed";
+  }
+  // Destroying the buffer writes out what is left.
+  EXPECT_EQ(file.read(), "hello 42\nunflushed");
+  ::close(fd);
+}
+
+TEST(FdStreamTest, WritesOfEverySizeArriveInOrder) {
+  TempFile const file("fd_stream_test.txt");
+  std::string expected;
+  int const fd =
+      ::open(file.path().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  ASSERT_GE(fd, 0);
+  {
+    FdOutputBuffer buffer(fd);
+    std::ostream out(&buffer);
+    // Small pieces, pieces that straddle the buffer's end, and pieces
+    // larger than the whole buffer.
+    for (std::size_t size :
+         {std::size_t{1}, std::size_t{100}, FdOutputBuffer::kBufferSize - 7,
+          FdOutputBuffer::kBufferSize * 3 + 5, std::size_t{13}}) {
+      std::string const piece(size, static_cast<char>('a' + size % 26));
+      out << piece;
+      expected += piece;
+    }
+  }
+  ::close(fd);
+  EXPECT_EQ(file.read(), expected);
+}
+
+TEST(FdStreamTest, ReadsLinesAcrossBufferBoundaries) {
+  TempFile const file("fd_stream_test.txt");
+  std::ostringstream contents;
+  for (int i = 0; i < 20000; ++i) {
+    contents << "line " << i << '\n';
+  }
+  contents << "last line without newline";
+  file.write(contents.str());
+  ASSERT_GT(contents.str().size(), 2 * FdInputBuffer::kBufferSize);
+
+  int const fd = ::open(file.path().c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+  FdInputBuffer buffer(fd);
+  std::istream in(&buffer);
+  std::string line;
+  for (int i = 0; i < 20000; ++i) {
+    ASSERT_TRUE(std::getline(in, line));
+    EXPECT_EQ(line, "line " + std::to_string(i));
+  }
+  ASSERT_TRUE(std::getline(in, line));
+  EXPECT_EQ(line, "last line without newline");
+  EXPECT_FALSE(std::getline(in, line));
+  ::close(fd);
+}
+
+}  // namespace lisp
@@ -0,0 +1,224 @@
+#include "gc.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "evaluator.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+class GcTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    evaluator = std::make_unique<Evaluator>();
+    collect_cycles();
+  }
+
+  ValuePtr eval_string(std::string const& input) {
+    Tokenizer tokenizer(input);
+    auto tokens = tokenizer.tokenize();
+    Parser parser(tokens);
+    return evaluator->eval(parser.parse());
+  }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+  std::unique_ptr<Evaluator> evaluator;
+};
+
+TEST_F(GcTest, ReclaimsFramesWithInternalClosures) {
+  eval_string(R"(
+        (define f
+          (lambda (x)
+            (define helper (lambda (y) (+ x y)))
+            (helper 1)))
+    )");
+  std::size_t const baseline = Environment::live_count();
+
+  eval_string("(f 1)");
+  eval_string("(f 2)");
+  EXPECT_GE(Environment::live_count(), baseline + 2);
+
+  EXPECT_GE(collect_cycles(), 2);
+  EXPECT_EQ(Environment::live_count(), baseline);
+}
+
+TEST_F(GcTest, KeepsReachableClosures) {
+  eval_string(R"(
+        (define make-adder
+          (lambda (x)
+            (define adder (lambda (y) (+ x y)))
+            adder))
+    )");
+  eval_string("(define add5 (make-adder 5))");
+  ValuePtr const add7 = eval_string("(make-adder 7)");
+
+  collect_cycles();
+
+  auto result = eval_string("(add5 1)");
+  EXPECT_DOUBLE_EQ(result->as_number(), 6.0);
+
+  // add7 is only referenced from this test.
+  ASSERT_TRUE(add7->is_lambda());
+  auto closure = add7->as_lambda().closure;
+  EXPECT_DOUBLE_EQ(closure->lookup("x")->as_number(), 7.0);
+  EXPECT_EQ(closure->lookup("adder"), add7);
+}
+
+TEST_F(GcTest, ReclaimsCycleOnceExternalReferenceDropped) {
+  auto env = std::make_shared<Environment>();
+  std::vector<ValuePtr> const body = {make_symbol("self")};
+  auto lambda = make_lambda({}, body, std::shared_ptr<Environment>(env));
+  env->define("self", lambda);
+
+  std::weak_ptr<Environment> const weak_env = env;
+  env.reset();
+
+  collect_cycles();
+  EXPECT_FALSE(weak_env.expired());  // Still reachable through `lambda`.
+
+  lambda.reset();
+  EXPECT_FALSE(weak_env.expired());  // Kept alive by the cycle alone.
+
+  EXPECT_EQ(collect_cycles(), 1);
+  EXPECT_TRUE(weak_env.expired());
+}
+
+TEST_F(GcTest, ReclaimsCyclesThroughVectors) {
+  eval_string(R"(
+        (define f
+          (lambda (x)
+            (define table (make-vector 1))
+            (vector-set! table 0 (lambda () table))
+            x))
+    )");
+  std::size_t const baseline = Environment::live_count();
+
+  eval_string("(f 1)");
+  EXPECT_GE(Environment::live_count(), baseline + 1);
+
+  EXPECT_GE(collect_cycles(), 1);
+  EXPECT_EQ(Environment::live_count(), baseline);
+}
+
+TEST_F(GcTest, ReclaimsCyclesThroughHashTables) {
+  eval_string(R"(
+        (define f
+          (lambda (x)
+            (define table (make-hash-table))
+            (hash-table-put! table 'self (lambda () table))
+            x))
+    )");
+  std::size_t const baseline = Environment::live_count();
+
+  eval_string("(f 1)");
+  EXPECT_GE(Environment::live_count(), baseline + 1);
+
+  EXPECT_GE(collect_cycles(), 1);
+  EXPECT_EQ(Environment::live_count(), baseline);
+}
+
+TEST_F(GcTest, CollectsDuringSingleLongRunningForm) {
+  for (auto engine :
+       {Evaluator::Engine::TREE_WALKER, Evaluator::Engine::BYTECODE}) {
+    evaluator = std::make_unique<Evaluator>(engine);
+    std::size_t peak = 0;
+    evaluator->get_global_env()->define(
+        "note-live-frames",
+        make_builtin([&peak](const std::vector<ValuePtr>& /*args*/,
+                             Environment& /*env*/) {
+          peak = std::max(peak, Environment::live_count());
+          return make_nil();
+        }));
+    eval_string(R"(
+          (define step
+            (lambda (x)
+              (define helper (lambda (y) (+ x y)))
+              (helper 1)))
+      )");
+    eval_string(R"(
+          (define run
+            (lambda (n)
+              (step n)
+              (note-live-frames)
+              (if (= n 0) 0 (run (- n 1)))))
+      )");
+    std::size_t const baseline = Environment::live_count();
+
+    // Each iteration leaves a frame cycle behind, which must be reclaimed
+    // before the form returns.
+    auto result = eval_string("(run 100000)");
+    EXPECT_EQ(result->as_integer(), 0);
+    EXPECT_LT(peak, baseline + 20000);
+  }
+}
+
+TEST_F(GcTest, YoungCollectionsLeaveOldFramesAlone) {
+  eval_string(R"(
+        (define make-adder
+          (lambda (x)
+            (define adder (lambda (y) (+ x y)))
+            adder))
+    )");
+  eval_string("(define add5 (make-adder 5))");
+  std::size_t const baseline = Environment::live_count();
+
+  // add5's frame survives a collection and becomes old.
+  EXPECT_EQ(collect_young_cycles({}, {}), 0);
+  EXPECT_EQ(Environment::young_count(), 0);
+
+  // Once dropped, its cycle is garbage that only a full collection scans.
+  eval_string("(define add5 0)");
+  eval_string("(make-adder 7)");
+  EXPECT_EQ(Environment::young_count(), 1);
+  EXPECT_EQ(collect_young_cycles({}, {}), 1);
+  EXPECT_EQ(Environment::live_count(), baseline);
+  EXPECT_EQ(collect_cycles(), 1);
+  EXPECT_EQ(Environment::live_count(), baseline - 1);
+}
+
+TEST_F(GcTest, ClosureCallsWithoutCyclesLeaveNothingToCollect) {
+  std::size_t peak = 0;
+  evaluator->get_global_env()->define(
+      "note-young-frames",
+      make_builtin([&peak](const std::vector<ValuePtr>& /*args*/,
+                           Environment& /*env*/) {
+        peak = std::max(peak, Environment::young_count());
+        return make_nil();
+      }));
+  eval_string(R"(
+        (define step (lambda (x) ((lambda (y) (+ x y)) 1)))
+    )");
+  eval_string(R"(
+        (define run
+          (lambda (n)
+            (step n)
+            (note-young-frames)
+            (if (= n 0) 0 (run (- n 1)))))
+    )");
+  collect_cycles();
+
+  // Reference counting frees every frame as its call returns, so the
+  // frame count never nears the collection threshold and calls pay only
+  // for the check.
+  eval_string("(run 100000)");
+  EXPECT_LT(peak, 16);
+}
+
+TEST_F(GcTest, EvaluatorDestructionReclaimsGlobalEnvironment) {
+  eval_string("(define loop (lambda (n) (if (= n 0) 0 (loop (- n 1)))))");
+  std::weak_ptr<Environment> const global = evaluator->get_global_env();
+
+  evaluator.reset();
+  EXPECT_TRUE(global.expired());
+}
+
+}  // namespace lisp
@@ -0,0 +1,109 @@
+#include "image.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "parser.hpp"
+#include "tokenizer.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+class ImageTest : public ::testing::Test {
+ protected:
+  static std::string write_image(const std::string& input) {
+    Tokenizer tokenizer(input);
+    Parser parser(tokenizer.tokenize());
+    std::ostringstream output;
+    ImageWriter writer(output);
+    for (const ValuePtr& form : parser.parse_multiple()) {
+      writer.write(form);
+    }
+    writer.finish();
+    return output.str();
+  }
+
+  static std::vector<std::string> read_image(const std::string& image) {
+    ImageReader reader(image);
+    std::vector<std::string> forms;
+    while (ValuePtr const form = reader.read()) {
+      forms.push_back(form->to_string());
+    }
+    return forms;
+  }
+};
+
+TEST_F(ImageTest, RoundTripsParsedForms) {
+  std::string const image = write_image(R"(
+        (define square (lambda (x) (* x x)))
+        (square -2.5)
+        '(nested (list "with \"text\"") nil)
+        sym
+    )");
+  EXPECT_TRUE(is_image(image));
+  EXPECT_EQ(read_image(image),
+            (std::vector<std::string>{
+                "(define square (lambda (x) (* x x)))", "(square -2.500000)",
+                "(quote (nested (list \"with \"text\"\") nil))", "sym"}));
+}
+
+TEST_F(ImageTest, PreservesValues) {
+  std::string const image = write_image("(0.1 -0.0 \"\" x x)");
+  ImageReader reader(image);
+  ValuePtr const form = reader.read();
+  ASSERT_TRUE(form);
+  EXPECT_DOUBLE_EQ(form->car()->as_number(), 0.1);
+  EXPECT_TRUE(std::signbit(form->cdr()->car()->as_number()));
+  EXPECT_EQ(form->cdr()->cdr()->car()->as_string(), "");
+  EXPECT_EQ(form->cdr()->cdr()->cdr()->car()->as_symbol(),
+            form->cdr()->cdr()->cdr()->cdr()->car()->as_symbol());
+  EXPECT_FALSE(reader.read());
+  EXPECT_FALSE(reader.read());
+}
+
+TEST_F(ImageTest, PreservesIntegers) {
+  std::string const image =
+      write_image("(-9007199254740993 7 7.0 123456789012345678901234567890)");
+  ImageReader reader(image);
+  ValuePtr const form = reader.read();
+  ASSERT_TRUE(form);
+  ASSERT_TRUE(form->car()->is_integer());
+  EXPECT_EQ(form->car()->as_integer(), -9007199254740993);
+  EXPECT_TRUE(form->cdr()->car()->is_integer());
+  EXPECT_FALSE(form->cdr()->cdr()->car()->is_integer());
+  ValuePtr const big = form->cdr()->cdr()->cdr()->car();
+  ASSERT_TRUE(big->is_bignum());
+  EXPECT_EQ(big->to_string(), "123456789012345678901234567890");
+}
+
+TEST_F(ImageTest, PreservesVectors) {
+  std::string const image = write_image("#(1 #(a \"b\") ()) #()");
+  EXPECT_EQ(read_image(image),
+            (std::vector<std::string>{"#(1 #(a \"b\") nil)", "#()"}));
+}
+
+TEST_F(ImageTest, EmptyImage) {
+  EXPECT_TRUE(read_image(write_image("")).empty());
+}
+
+TEST_F(ImageTest, RejectsMalformedImages) {
+  EXPECT_THROW(ImageReader("(+ 1 2)"), ImageError);
+
+  std::string image = write_image("(a b c)");
+  EXPECT_THROW(read_image(image.substr(0, image.size() - 3)), ImageError);
+
+  image[kImageMagic.size()] = 99;  // Version byte
+  EXPECT_THROW(ImageReader{image}, ImageError);
+}
+
+TEST_F(ImageTest, OnlyWritesData) {
+  std::ostringstream output;
+  ImageWriter writer(output);
+  EXPECT_THROW(writer.write(make_builtin(nullptr)), ImageError);
+}
+
+}  // namespace lisp
@@ -0,0 +1,38 @@
+#include "mapped_file.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "temp_file.hpp"
+
+namespace lisp {
+
+TEST(MappedFileTest, MapsRegularFile) {
+  TempFile const file("mapped_file_test.lisp");
+  file.write("(define x 1)\n(+ x 2)\n");
+  MappedFile const mapped(file.path());
+  ASSERT_TRUE(mapped.is_mapped());
+  EXPECT_EQ(mapped.contents(), "(define x 1)\n(+ x 2)\n");
+}
+
+TEST(MappedFileTest, EmptyFileIsNotMapped) {
+  TempFile const file("mapped_file_test.lisp");
+  file.write("");
+  MappedFile const mapped(file.path());
+  EXPECT_FALSE(mapped.is_mapped());
+  EXPECT_TRUE(mapped.contents().empty());
+}
+
+TEST(MappedFileTest, MissingFileIsNotMapped) {
+  TempFile const file("mapped_file_test.lisp");
+  MappedFile const mapped(file.path() + ".missing");
+  EXPECT_FALSE(mapped.is_mapped());
+}
+
+TEST(MappedFileTest, NonRegularFileIsNotMapped) {
+  MappedFile const mapped("/dev/null");
+  EXPECT_FALSE(mapped.is_mapped());
+}
+
+}  // namespace lisp
@@ -45,6 +45,23 @@ TEST_F(ParserTest, ParseNumbers) {
   EXPECT_DOUBLE_EQ(result->as_number(), 123.0);
 }
 
+TEST_F(ParserTest, IntegerAndDecimalLiterals) {
+  auto result = parse_string("9007199254740993");
+  ASSERT_TRUE(result->is_integer());
+  EXPECT_EQ(result->as_integer(), 9007199254740993);
+
+  result = parse_string("+7");
+  ASSERT_TRUE(result->is_integer());
+  EXPECT_EQ(result->as_integer(), 7);
+
+  EXPECT_FALSE(parse_string("7.0")->is_integer());
+
+  // Too large for 64 bits, so read as a bignum.
+  result = parse_string("-123456789012345678901234567890");
+  ASSERT_TRUE(result->is_bignum());
+  EXPECT_EQ(result->to_string(), "-123456789012345678901234567890");
+}
+
 TEST_F(ParserTest, ParseStrings) {
   auto result = parse_string("\"hello\"");
   EXPECT_TRUE(result->is_string());
@@ -149,6 +166,19 @@ TEST_F(ParserTest, ParseMixedTypes) {
   EXPECT_TRUE(rest->cdr()->is_nil());
 }
 
+TEST_F(ParserTest, ParseVector) {
+  auto result = parse_string("#(1 \"two\" (3) #())");
+  ASSERT_TRUE(result->is_vector());
+  ASSERT_EQ(result->as_vector().size(), 4);
+  EXPECT_EQ(result->as_vector()[0]->as_integer(), 1);
+  EXPECT_EQ(result->as_vector()[1]->as_string(), "two");
+  EXPECT_TRUE(result->as_vector()[2]->is_cons());
+  EXPECT_TRUE(result->as_vector()[3]->is_vector());
+  EXPECT_EQ(result->to_string(), "#(1 \"two\" (3) #())");
+
+  EXPECT_THROW(parse_string("#(1 2"), ParseError);
+}
+
 TEST_F(ParserTest, ParseQuotedAtom) {
   auto result = parse_string("'hello");
   EXPECT_TRUE(result->is_cons());
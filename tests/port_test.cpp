@@ -0,0 +1,84 @@
+#include "port.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <memory>
+#include <string>
+
+#include "temp_file.hpp"
+
+namespace lisp {
+
+TEST(PortTest, WritesReachTheFileWhenClosed) {
+  TempFile const file("port_test.txt");
+  std::unique_ptr<Port> port = Port::open(file.path(), Port::Direction::OUTPUT);
+  ASSERT_NE(port, nullptr);
+  EXPECT_FALSE(port->is_input());
+  EXPECT_TRUE(port->is_open());
+  port->stream() << "first\nsecond";
+  EXPECT_EQ(file.read(), "");
+  EXPECT_TRUE(port->close());
+  EXPECT_FALSE(port->is_open());
+  EXPECT_EQ(file.read(), "first\nsecond");
+  // Closing again does nothing.
+  EXPECT_TRUE(port->close());
+}
+
+TEST(PortTest, DestroyingAnOutputPortFlushesIt) {
+  TempFile const file("port_test.txt");
+  Port::open(file.path(), Port::Direction::OUTPUT)->stream() << "kept";
+  EXPECT_EQ(file.read(), "kept");
+}
+
+TEST(PortTest, OpeningForOutputTruncates) {
+  TempFile const file("port_test.txt");
+  file.write("old contents");
+  ASSERT_TRUE(Port::open(file.path(), Port::Direction::OUTPUT)->close());
+  EXPECT_EQ(file.read(), "");
+}
+
+TEST(PortTest, ReadsLinesAndCharacters) {
+  TempFile const file("port_test.txt");
+  file.write("ab\ncd\n");
+  std::unique_ptr<Port> port = Port::open(file.path(), Port::Direction::INPUT);
+  ASSERT_NE(port, nullptr);
+  EXPECT_TRUE(port->is_input());
+  char c = 0;
+  ASSERT_TRUE(port->stream().get(c));
+  EXPECT_EQ(c, 'a');
+  std::string line;
+  ASSERT_TRUE(std::getline(port->stream(), line));
+  EXPECT_EQ(line, "b");
+  ASSERT_TRUE(std::getline(port->stream(), line));
+  EXPECT_EQ(line, "cd");
+  EXPECT_FALSE(std::getline(port->stream(), line));
+  EXPECT_TRUE(port->close());
+}
+
+TEST(PortTest, ReadsFilesLargerThanItsBuffer) {
+  TempFile const file("port_test.txt");
+  std::string expected;
+  for (int i = 0; i < 20000; ++i) {
+    expected += "line " + std::to_string(i) + "\n";
+  }
+  file.write(expected);
+  std::unique_ptr<Port> port = Port::open(file.path(), Port::Direction::INPUT);
+  ASSERT_NE(port, nullptr);
+  std::string contents;
+  std::string line;
+  while (std::getline(port->stream(), line)) {
+    contents += line + "\n";
+  }
+  EXPECT_EQ(contents, expected);
+}
+
+TEST(PortTest, MissingFileIsNotOpened) {
+  TempFile const file("port_test.txt");
+  errno = 0;
+  EXPECT_EQ(Port::open(file.path() + ".missing", Port::Direction::INPUT),
+            nullptr);
+  EXPECT_EQ(errno, ENOENT);
+}
+
+}  // namespace lisp
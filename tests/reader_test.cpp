@@ -0,0 +1,98 @@
+#include "reader.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parser.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+class ReaderTest : public ::testing::Test {
+ protected:
+  static std::vector<std::string> read_forms(Reader& reader) {
+    std::vector<std::string> forms;
+    while (ValuePtr const form = reader.read()) {
+      forms.push_back(form->to_string());
+    }
+    return forms;
+  }
+
+  // Reads `input` both as a stream and in place; the two must agree.
+  static std::vector<std::string> read_all(const std::string& input) {
+    std::istringstream stream(input);
+    Reader stream_reader(stream);
+    Reader source_reader{std::string_view(input)};
+
+    std::vector<std::string> forms = read_forms(stream_reader);
+    EXPECT_EQ(read_forms(source_reader), forms) << "input: " << input;
+    return forms;
+  }
+};
+
+TEST_F(ReaderTest, EmptyInput) {
+  EXPECT_TRUE(read_all("").empty());
+  EXPECT_TRUE(read_all("  \n\t ; only a comment\n").empty());
+}
+
+TEST_F(ReaderTest, SplitsTopLevelForms) {
+  EXPECT_EQ(read_all("42 \"hello\" (+ 1 2) sym"),
+            (std::vector<std::string>{"42", "\"hello\"", "(+ 1 2)", "sym"}));
+  EXPECT_EQ(read_all("(a (b c))(d)'e '(f)"),
+            (std::vector<std::string>{"(a (b c))", "(d)", "(quote e)",
+                                      "(quote (f))"}));
+}
+
+TEST_F(ReaderTest, MatchesTokenizerBoundaries) {
+  EXPECT_EQ(read_all("abc\"x\""),
+            (std::vector<std::string>{"abc", "\"x\""}));
+  EXPECT_EQ(read_all("12abc"), (std::vector<std::string>{"12", "abc"}));
+  EXPECT_EQ(read_all("a;comment\nb"), (std::vector<std::string>{"a", "b"}));
+}
+
+TEST_F(ReaderTest, VectorLiterals) {
+  EXPECT_EQ(read_all("#(1 (2)) #t #(3)"),
+            (std::vector<std::string>{"#(1 (2))", "#t", "#(3)"}));
+}
+
+TEST_F(ReaderTest, DelimitersInsideStringsAndComments) {
+  EXPECT_EQ(read_all(R"(("a)b" ; (
+  "c\"d") x)"),
+            (std::vector<std::string>{"(\"a)b\" \"c\"d\")", "x"}));
+}
+
+TEST_F(ReaderTest, ReadsOneFormAtATime) {
+  std::istringstream stream("(first) (second");
+  Reader reader(stream);
+
+  ValuePtr const form = reader.read();
+  ASSERT_TRUE(form);
+  EXPECT_EQ(form->to_string(), "(first)");
+  EXPECT_THROW(reader.read(), ParseError);
+}
+
+TEST_F(ReaderTest, ContinuesAfterParseError) {
+  std::istringstream stream(") 1");
+  Reader reader(stream);
+
+  EXPECT_THROW(reader.read(), ParseError);
+  ValuePtr const form = reader.read();
+  ASSERT_TRUE(form);
+  EXPECT_DOUBLE_EQ(form->as_number(), 1.0);
+  EXPECT_FALSE(reader.read());
+}
+
+TEST_F(ReaderTest, SourceFormsDoNotReferToTheInput) {
+  std::string input = "(define \"s\" sym)";
+  Reader reader{std::string_view(input)};
+  ValuePtr const form = reader.read();
+  input.assign(input.size(), 'x');
+
+  EXPECT_EQ(form->to_string(), "(define \"s\" sym)");
+}
+
+}  // namespace lisp
@@ -3,6 +3,13 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "image.hpp"
+#include "parser.hpp"
+#include "reader.hpp"
 
 namespace lisp {
 
@@ -305,4 +312,65 @@ TEST_F(REPLTest, EvalLambdaWithMultipleBodyComponents) {
   EXPECT_DOUBLE_EQ(result->as_number(), 13.0);
 }
 
+TEST_F(REPLTest, EvalStreamEvaluatesFormsAsRead) {
+  std::istringstream input(R"(
+        (define x 1)
+        (define x (+ x 1))
+        (* x 10)
+        (+ x
+    )");
+
+  // The complete forms before the malformed one have already run.
+  EXPECT_THROW(repl->eval_stream(input), ParseError);
+  auto result = repl->eval_string("x");
+  EXPECT_DOUBLE_EQ(result->as_number(), 2.0);
+
+  std::istringstream empty("  ; nothing here\n");
+  EXPECT_FALSE(repl->eval_stream(empty));
+
+  std::istringstream more("(define y 5) (* x y)");
+  result = repl->eval_stream(more);
+  EXPECT_DOUBLE_EQ(result->as_number(), 10.0);
+}
+
+TEST_F(REPLTest, EvalSourceInPlace) {
+  std::string const source = "(define z 4) ; comment\n(* z z)";
+  auto result = repl->eval_source(source);
+  EXPECT_DOUBLE_EQ(result->as_number(), 16.0);
+  EXPECT_FALSE(repl->eval_source(""));
+}
+
+TEST_F(REPLTest, EvalImage) {
+  std::ostringstream image;
+  ImageWriter writer(image);
+  std::string const source = "(define sq (lambda (x) (* x x))) (sq 7)";
+  Reader reader{std::string_view(source)};
+  while (ValuePtr const form = reader.read()) {
+    writer.write(form);
+  }
+  writer.finish();
+
+  auto result = repl->eval_image(image.str());
+  EXPECT_DOUBLE_EQ(result->as_number(), 49.0);
+  EXPECT_THROW(repl->eval_image(source), ImageError);
+}
+
+TEST(REPLBytecodeTest, EvalStringOnVirtualMachine) {
+  REPL repl(Evaluator::Engine::BYTECODE);
+  repl.eval_string(R"(
+        (define fact
+          (lambda (n)
+            (if (< n 2)
+                1
+                (* n (fact (- n 1))))))
+    )");
+  auto result = repl.eval_string("(fact 10) (fact 5)");
+  EXPECT_TRUE(result->is_number());
+  EXPECT_DOUBLE_EQ(result->as_number(), 120.0);
+
+  EXPECT_THROW(repl.eval_string("(fact)"), EvalError);
+  result = repl.eval_string("(fact 3)");
+  EXPECT_DOUBLE_EQ(result->as_number(), 6.0);
+}
+
 }  // namespace lisp
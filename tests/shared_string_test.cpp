@@ -0,0 +1,120 @@
+#include "shared_string.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+
+namespace lisp {
+
+TEST(SharedStringTest, CopiesShareCharacters) {
+  SharedString const text(std::string("hello, world"));
+  // NOLINTNEXTLINE(performance-unnecessary-copy-initialization)
+  SharedString const copy = text;
+  EXPECT_EQ(copy.view(), "hello, world");
+  EXPECT_EQ(copy.view().data(), text.view().data());
+  EXPECT_EQ(copy, text);
+
+  SharedString const empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(empty.view(), "");
+  EXPECT_EQ(empty, SharedString(std::string()));
+}
+
+TEST(SharedStringTest, SubstringsShareCharacters) {
+  SharedString const text(std::string("2026-10-16 INFO started"));
+  SharedString const level = text.substr(11, 4);
+  EXPECT_EQ(level.view(), "INFO");
+  EXPECT_EQ(level.view().data(), text.view().data() + 11);
+
+  SharedString const inner = level.substr(1, 2);
+  EXPECT_EQ(inner.view(), "NF");
+  EXPECT_EQ(inner.view().data(), text.view().data() + 12);
+  EXPECT_TRUE(text.substr(5, 0).empty());
+}
+
+TEST(SharedStringTest, ShortConcatenationsAreFlat) {
+  SharedString const joined = SharedString::concat(
+      SharedString(std::string("foo")), SharedString(std::string("bar")));
+  EXPECT_EQ(joined.view(), "foobar");
+  EXPECT_EQ(SharedString::concat(joined, SharedString()).view().data(),
+            joined.view().data());
+}
+
+TEST(SharedStringTest, LongConcatenationsFlattenOnDemand) {
+  std::string const chunk(SharedString::kMinRopeLength, 'x');
+  SharedString const left(chunk);
+  SharedString const right(std::string(chunk.size(), 'y'));
+  SharedString const rope = SharedString::concat(left, right);
+  EXPECT_EQ(rope.size(), 2 * chunk.size());
+  EXPECT_EQ(rope.view(), chunk + std::string(chunk.size(), 'y'));
+
+  SharedString const middle = rope.substr(chunk.size() - 1, 2);
+  EXPECT_EQ(middle.view(), "xy");
+  EXPECT_EQ(middle.view().data(), rope.view().data() + chunk.size() - 1);
+}
+
+TEST(SharedStringTest, RepeatedAppendsStayCorrect) {
+  std::string const line(SharedString::kMinRopeLength, 'a');
+  std::string expected;
+  SharedString text;
+  // Enough appends to pass kMaxDepth several times.
+  for (std::size_t i = 0; i < 4 * SharedString::kMaxDepth + 3; ++i) {
+    std::string const piece = line + std::to_string(i);
+    expected += piece;
+    text = SharedString::concat(text, SharedString(piece));
+    // Prepending as well exercises ropes on both sides.
+    if (i % 7 == 0) {
+      expected = piece + expected;
+      text = SharedString::concat(SharedString(piece), text);
+    }
+  }
+  EXPECT_EQ(text.size(), expected.size());
+  EXPECT_EQ(text.view(), expected);
+}
+
+TEST(SharedStringTest, ManyAppendsRebalanceWithoutFlattening) {
+  std::string const block(SharedString::kMaxLeafLength, 'b');
+  std::string expected;
+  SharedString text;
+  for (std::size_t i = 0; i < 50 * SharedString::kMaxDepth; ++i) {
+    std::string const piece = std::to_string(i) + block;
+    expected += piece;
+    text = SharedString::concat(text, SharedString(piece));
+    ASSERT_EQ(text.depth() == 0, i == 0);
+    ASSERT_LE(text.depth(), SharedString::kMaxDepth);
+  }
+  EXPECT_EQ(text.size(), expected.size());
+  EXPECT_EQ(text.view(), expected);
+  EXPECT_EQ(text.depth(), 0U);
+}
+
+TEST(SharedStringTest, LineAppendsFillLeavesInPlace) {
+  SharedString text(std::string(SharedString::kMinRopeLength, '#'));
+  std::string expected(text.view());
+  constexpr std::size_t kLines = 20000;
+  for (std::size_t i = 0; i < kLines; ++i) {
+    std::string const line = "line " + std::to_string(i) + "\n";
+    expected += line;
+    text = SharedString::concat(text, SharedString(line));
+  }
+  // One level per full leaf, not per append.
+  EXPECT_LE(text.depth(), expected.size() / SharedString::kMaxLeafLength + 2);
+  EXPECT_EQ(text.view(), expected);
+}
+
+TEST(SharedStringTest, AppendsToTheSameStringStayIndependent) {
+  std::string const prefix(SharedString::kMinRopeLength, 'p');
+  SharedString const base = SharedString::concat(
+      SharedString(prefix), SharedString(std::string("-")));
+  SharedString const first = SharedString::concat(base, SharedString(std::string("one")));
+  SharedString const second = SharedString::concat(base, SharedString(std::string("two")));
+  SharedString const third =
+      SharedString::concat(first, SharedString(std::string("!")));
+  EXPECT_EQ(base.view(), prefix + "-");
+  EXPECT_EQ(first.view(), prefix + "-one");
+  EXPECT_EQ(second.view(), prefix + "-two");
+  EXPECT_EQ(third.view(), prefix + "-one!");
+}
+
+}  // namespace lisp
@@ -0,0 +1,37 @@
+#include "symbol.hpp"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <string>
+
+namespace lisp {
+
+TEST(SymbolTest, InternReturnsSameSymbol) {
+  Symbol const first = intern("foo");
+  Symbol const second = intern(std::string("foo"));
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first.id(), second.id());
+  EXPECT_EQ(&first.name(), &second.name());
+}
+
+TEST(SymbolTest, DistinctNamesAreDistinctSymbols) {
+  Symbol const foo = intern("foo");
+  Symbol const bar = intern("bar");
+  EXPECT_NE(foo, bar);
+  EXPECT_NE(foo.id(), bar.id());
+}
+
+TEST(SymbolTest, NameRoundTrip) {
+  Symbol const symbol = intern("hello-world");
+  EXPECT_EQ(symbol.name(), "hello-world");
+  EXPECT_EQ(symbol, "hello-world");
+  EXPECT_FALSE(symbol == "hello");
+}
+
+TEST(SymbolTest, HashUsesIdentity) {
+  Symbol const symbol = intern("hashed");
+  EXPECT_EQ(std::hash<Symbol>{}(symbol), std::hash<Symbol>{}(intern("hashed")));
+}
+
+}  // namespace lisp
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace lisp {
+
+// A file named `name` in the test's temporary directory, removed when the
+// TempFile goes out of scope. The file itself is only created by writing to
+// it.
+class TempFile {
+ public:
+  explicit TempFile(const std::string& name)
+      : file_path(::testing::TempDir() + name) {}
+  ~TempFile() { std::remove(file_path.c_str()); }
+  TempFile(const TempFile&) = delete;
+  TempFile& operator=(const TempFile&) = delete;
+
+  const std::string& path() const { return file_path; }
+
+  // Replaces the file's contents with `contents`.
+  void write(const std::string& contents) const {
+    std::ofstream file(file_path, std::ios::binary);
+    file << contents;
+  }
+
+  std::string read() const {
+    std::ifstream file(file_path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()};
+  }
+
+ private:
+  std::string file_path;
+};
+
+}  // namespace lisp
@@ -4,6 +4,7 @@
 
 #include <cstddef>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -57,6 +58,14 @@ TEST_F(TokenizerTest, Quote) {
                      {{TokenType::QUOTE, "'"}, {TokenType::SYMBOL, "symbol"}});
 }
 
+TEST_F(TokenizerTest, VectorStart) {
+  tokenize_and_check("#(1 #t)", {{TokenType::VECTOR_START, "#("},
+                                 {TokenType::NUMBER, "1"},
+                                 {TokenType::SYMBOL, "#t"},
+                                 {TokenType::RPAREN, ")"}});
+  tokenize_and_check("#f", {{TokenType::SYMBOL, "#f"}});
+}
+
 TEST_F(TokenizerTest, Numbers) {
   tokenize_and_check("42", {{TokenType::NUMBER, "42"}});
   tokenize_and_check("3.14", {{TokenType::NUMBER, "3.14"}});
@@ -219,6 +228,27 @@ TEST_F(TokenizerTest, TokenPositions) {
   EXPECT_EQ(tokens[4].position(), 6);  // )
 }
 
+TEST_F(TokenizerTest, TokensViewTheInput) {
+  std::string const input = R"((define s "plain" "esc\"aped"))";
+  Tokenizer tokenizer(input);
+  auto tokens = tokenizer.tokenize();
+
+  ASSERT_EQ(tokens.size(), 7);
+  auto in_input = [&input](std::string_view text) {
+    return text.data() >= input.data() &&
+           text.data() + text.size() <= input.data() + input.size();
+  };
+  EXPECT_TRUE(in_input(tokens[1].value()));  // define
+  EXPECT_TRUE(in_input(tokens[2].value()));  // s
+  EXPECT_TRUE(in_input(tokens[3].value()));  // "plain"
+  EXPECT_EQ(tokens[3].value(), "plain");
+
+  // Only the literal with an escape sequence is decoded into its own copy.
+  EXPECT_FALSE(in_input(tokens[4].value()));
+  EXPECT_EQ(tokens[4].value(), "esc\"aped");
+  EXPECT_EQ(tokens[4].position(), 18);
+}
+
 TEST_F(TokenizerTest, NextTokenMethod) {
   Tokenizer tokenizer("(+ 1)");
 
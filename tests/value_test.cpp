@@ -2,7 +2,13 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cmath>
 #include <memory>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -42,6 +48,47 @@ TEST_F(ValueTest, NumberValue) {
   EXPECT_DOUBLE_EQ(num_val->as_number(), kTestNumber);
 }
 
+TEST_F(ValueTest, SmallIntegersAreShared) {
+  EXPECT_EQ(make_number(0), make_number(0));
+  EXPECT_EQ(make_number(7), make_number(7.0));
+  EXPECT_EQ(make_number(-1), make_number(-1));
+  EXPECT_NE(make_number(0.5), make_number(0.5));
+
+  auto negative_zero = make_number(-0.0);
+  EXPECT_NE(negative_zero, make_number(0));
+  EXPECT_TRUE(std::signbit(negative_zero->as_number()));
+}
+
+TEST_F(ValueTest, IntegerValue) {
+  auto const integer = make_integer(1234567890123);
+  EXPECT_TRUE(integer->is_number());
+  EXPECT_TRUE(integer->is_integer());
+  EXPECT_EQ(integer->type, ValueType::NUMBER);
+  EXPECT_EQ(integer->as_integer(), 1234567890123);
+  EXPECT_DOUBLE_EQ(integer->as_number(), 1234567890123.0);
+  EXPECT_EQ(integer->to_string(), "1234567890123");
+  EXPECT_FALSE(make_number(2.0)->is_integer());
+
+  EXPECT_EQ(make_integer(7), make_integer(7));
+  EXPECT_NE(make_integer(7), make_number(7));
+}
+
+TEST_F(ValueTest, LargeDoublesPrint) {
+  EXPECT_EQ(make_number(3e9)->to_string(), "3000000000");
+  EXPECT_EQ(make_number(-2.5)->to_string(), "-2.500000");
+  EXPECT_EQ(make_number(1e300)->to_string().substr(0, 4), "1000");
+}
+
+TEST_F(ValueTest, ConstantsAreShared) {
+  EXPECT_EQ(make_nil(), make_nil());
+  EXPECT_EQ(make_true(), make_true());
+  EXPECT_EQ(make_false(), make_false());
+
+  EXPECT_TRUE(make_true()->is_symbol());
+  EXPECT_EQ(make_true()->as_symbol(), "#t");
+  EXPECT_EQ(make_false()->as_symbol(), "#f");
+}
+
 TEST_F(ValueTest, StringValue) {
   const char* kTestString = "hello world";
   auto str_val = make_string(kTestString);
@@ -90,6 +137,92 @@ TEST_F(ValueTest, ConsValue) {
   EXPECT_DOUBLE_EQ(cons_val->cdr()->as_number(), 2.0);
 }
 
+TEST_F(ValueTest, F64ArrayValue) {
+  F64Array array(3, 1.5);
+  array[2] = 4;
+  auto array_val = make_f64array(std::move(array));
+
+  EXPECT_TRUE(array_val->is_f64array());
+  EXPECT_FALSE(array_val->is_vector());
+  EXPECT_EQ(array_val->type, ValueType::F64ARRAY);
+  EXPECT_EQ(array_val->as_f64array().size(), 3);
+  EXPECT_EQ(array_val->to_string(), "#f64(1.500000 1.500000 4)");
+  EXPECT_EQ(make_f64array(F64Array())->to_string(), "#f64()");
+}
+
+TEST_F(ValueTest, HashTableValue) {
+  auto table_val = make_hash_table();
+  EXPECT_TRUE(table_val->is_hash_table());
+  EXPECT_EQ(table_val->type, ValueType::HASHTABLE);
+  EXPECT_EQ(table_val->as_hash_table().size(), 0);
+  EXPECT_EQ(table_val->to_string(), "#<hash-table>");
+}
+
+TEST_F(ValueTest, PrintsNestedStructures) {
+  ValuePtr const dotted = make_cons(make_symbol("a"), make_integer(1));
+  ValuePtr const list = make_cons(
+      dotted,
+      make_cons(make_vector({make_nil(), make_vector({}), make_string("s")}),
+                make_cons(make_number(0.25), make_nil())));
+  EXPECT_EQ(list->to_string(), "((a . 1) #(nil #() \"s\") 0.250000)");
+  EXPECT_EQ(make_cons(make_integer(1), dotted)->to_string(), "(1 a . 1)");
+  EXPECT_EQ(make_vector({make_cons(make_nil(), make_nil())})->to_string(),
+            "#((nil))");
+
+  std::ostringstream stream;
+  print_value(*list, stream);
+  EXPECT_EQ(stream.str(), list->to_string());
+
+  std::string buffer = "=> ";
+  print_value(*dotted, buffer);
+  EXPECT_EQ(buffer, "=> (a . 1)");
+}
+
+TEST_F(ValueTest, PrintingReportsStreamFailures) {
+  // A buffer that accepts nothing.
+  struct FullBuffer : std::streambuf {};
+  FullBuffer full;
+  std::ostream rejected(&full);
+  print_value(*make_string("text"), rejected);
+  EXPECT_TRUE(rejected.bad());
+
+  std::ostream unbuffered(nullptr);
+  print_value(*make_integer(1), unbuffered);
+  EXPECT_TRUE(unbuffered.bad());
+
+  // Printing flushes the tied stream first.
+  struct SyncCounter : std::stringbuf {
+    int syncs = 0;
+    int sync() override {
+      ++syncs;
+      return 0;
+    }
+  };
+  SyncCounter counter;
+  std::ostream tied(&counter);
+  std::ostringstream stream;
+  stream.tie(&tied);
+  print_value(*make_integer(2), stream);
+  EXPECT_EQ(counter.syncs, 1);
+  EXPECT_EQ(stream.str(), "2");
+}
+
+TEST_F(ValueTest, PrintsDeepAndLongStructuresIteratively) {
+  constexpr int kDepth = 1000;
+  ValuePtr nested = make_nil();
+  for (int i = 0; i < kDepth; ++i) {
+    nested = make_cons(nested, make_nil());
+  }
+  std::string const text = nested->to_string();
+  EXPECT_EQ(text, std::string(kDepth, '(') + "nil" + std::string(kDepth, ')'));
+
+  ValuePtr list = make_nil();
+  for (int i = 0; i < 5000; ++i) {
+    list = make_cons(make_integer(7), list);
+  }
+  EXPECT_EQ(list->to_string().size(), 2 * 5000 + 1);
+}
+
 TEST_F(ValueTest, BuiltinValue) {
   auto builtin_func = [](const std::vector<ValuePtr>& /*args*/,
                          Environment& /*env*/) -> ValuePtr {
@@ -109,8 +242,28 @@ TEST_F(ValueTest, BuiltinValue) {
   EXPECT_EQ(result->as_string(), "builtin");
 }
 
+TEST_F(ValueTest, NativeBuiltinValue) {
+  ValuePtr (*second)(const ValuePtr&, const ValuePtr&) =
+      [](const ValuePtr& /*first*/, const ValuePtr& second) {
+        return second;
+      };
+  ValuePtr const native_val = make_native("second", second);
+
+  EXPECT_EQ(native_val->type, ValueType::BUILTIN);
+  EXPECT_TRUE(native_val->is_builtin());
+  EXPECT_TRUE(native_val->is_native());
+  EXPECT_FALSE(make_builtin(nullptr)->is_native());
+
+  const NativeBuiltin& native = native_val->as_native();
+  EXPECT_EQ(native.arity(), 2U);
+  EXPECT_EQ(native.arity_error(), "second requires exactly two arguments");
+
+  std::array<ValuePtr, 2> const args = {make_number(1), make_number(2)};
+  EXPECT_DOUBLE_EQ(native.call(args.data())->as_number(), 2.0);
+}
+
 TEST_F(ValueTest, LambdaValue) {
-  std::vector<std::string> const params = {"x", "y"};
+  std::vector<Symbol> const params = {intern("x"), intern("y")};
   std::vector<ValuePtr> body = {make_symbol("+")};
   auto closure = std::make_shared<Environment>();
   auto lambda_val = make_lambda(params, body, std::move(closure));
@@ -212,4 +365,138 @@ TEST_F(EnvironmentTest, ExtendEnvironment) {
   EXPECT_EQ(env->lookup("new_var"), nullptr);
 }
 
+TEST_F(EnvironmentTest, ManyBindings) {
+  // Enough names to outgrow the inline bindings and move to a hash table.
+  constexpr int kCount = 20;
+  for (int i = 0; i < kCount; ++i) {
+    env->define("var" + std::to_string(i), make_number(i));
+    for (int j = 0; j <= i; ++j) {
+      ValuePtr const value = env->lookup("var" + std::to_string(j));
+      ASSERT_NE(value, nullptr);
+      EXPECT_DOUBLE_EQ(value->as_number(), j);
+    }
+  }
+  env->define("var3", make_number(-3));
+  EXPECT_DOUBLE_EQ(env->lookup("var3")->as_number(), -3.0);
+  EXPECT_EQ(env->lookup("var20"), nullptr);
+}
+
+TEST(HashTableTest, InsertFindAndErase) {
+  HashTable table;
+  EXPECT_EQ(table.find(*make_symbol("a")), nullptr);
+
+  table.insert_or_assign(make_symbol("a"), make_integer(1));
+  table.insert_or_assign(make_string("a"), make_integer(2));
+  table.insert_or_assign(make_integer(7), make_integer(3));
+  EXPECT_EQ(table.size(), 3);
+  EXPECT_EQ((*table.find(*make_symbol("a")))->as_integer(), 1);
+  EXPECT_EQ((*table.find(*make_string("a")))->as_integer(), 2);
+
+  // Numbers are keyed by value, whether exact or not.
+  EXPECT_EQ((*table.find(*make_number(7.0)))->as_integer(), 3);
+  table.insert_or_assign(make_number(7.0), make_integer(4));
+  EXPECT_EQ(table.size(), 3);
+  EXPECT_EQ((*table.find(*make_integer(7)))->as_integer(), 4);
+  EXPECT_EQ(table.find(*make_number(7.5)), nullptr);
+
+  EXPECT_TRUE(table.erase(*make_string("a")));
+  EXPECT_FALSE(table.erase(*make_string("a")));
+  EXPECT_EQ(table.find(*make_string("a")), nullptr);
+  EXPECT_EQ(table.size(), 2);
+}
+
+TEST(HashTableTest, MixedNumberKeysCompareExactly) {
+  constexpr std::int64_t kTwo60 = std::int64_t{1} << 60;
+  HashTable table;
+  table.insert_or_assign(make_integer(kTwo60 + 1), make_integer(1));
+  // 2^60 + 1 rounds to the double 2^60, but is not equal to it.
+  EXPECT_EQ(table.find(*make_number(static_cast<double>(kTwo60))), nullptr);
+  table.insert_or_assign(make_number(static_cast<double>(kTwo60)),
+                         make_integer(2));
+  EXPECT_EQ(table.size(), 2);
+  EXPECT_EQ((*table.find(*make_integer(kTwo60)))->as_integer(), 2);
+  EXPECT_EQ((*table.find(*make_integer(kTwo60 + 1)))->as_integer(), 1);
+
+  // Likewise for bignums and doubles outside int64_t's range.
+  BigInt const two70 = *BigInt::parse("1180591620717411303424");
+  double const two70_double = std::ldexp(1.0, 70);
+  table.insert_or_assign(make_integer(two70 + BigInt(1)), make_integer(3));
+  EXPECT_EQ(table.find(*make_number(two70_double)), nullptr);
+  table.insert_or_assign(make_integer(two70), make_integer(4));
+  EXPECT_EQ((*table.find(*make_number(two70_double)))->as_integer(), 4);
+  EXPECT_EQ(table.find(*make_number(-two70_double)), nullptr);
+  EXPECT_EQ(table.size(), 4);
+}
+
+TEST(HashTableTest, GrowsAndReusesDeletedSlots) {
+  HashTable table;
+  for (std::int64_t i = 0; i < 10000; ++i) {
+    table.insert_or_assign(make_integer(i), make_integer(i * i));
+  }
+  for (std::int64_t i = 0; i < 10000; i += 2) {
+    EXPECT_TRUE(table.erase(*make_integer(i)));
+  }
+  // Churn through many deletions without the table filling with
+  // tombstones.
+  for (std::int64_t round = 0; round < 10; ++round) {
+    for (std::int64_t i = 0; i < 1000; ++i) {
+      table.insert_or_assign(make_integer(-i - 1), make_nil());
+    }
+    for (std::int64_t i = 0; i < 1000; ++i) {
+      EXPECT_TRUE(table.erase(*make_integer(-i - 1)));
+    }
+  }
+  EXPECT_EQ(table.size(), 5000);
+  for (std::int64_t i = 0; i < 10000; ++i) {
+    ValuePtr* const value = table.find(*make_integer(i));
+    if (i % 2 == 0) {
+      EXPECT_EQ(value, nullptr);
+    } else {
+      ASSERT_NE(value, nullptr);
+      EXPECT_EQ((*value)->as_integer(), i * i);
+    }
+  }
+
+  std::size_t visited = 0;
+  table.for_each([&](const ValuePtr& key, const ValuePtr& value) {
+    EXPECT_EQ(value->as_integer(), key->as_integer() * key->as_integer());
+    ++visited;
+  });
+  EXPECT_EQ(visited, 5000);
+}
+
+TEST(HashTableTest, OnlyAtomsAreHashable) {
+  EXPECT_TRUE(HashTable::is_hashable(*make_number(1.5)));
+  EXPECT_TRUE(HashTable::is_hashable(*make_string("x")));
+  EXPECT_TRUE(HashTable::is_hashable(*make_symbol("x")));
+  EXPECT_FALSE(HashTable::is_hashable(*make_nil()));
+  EXPECT_FALSE(HashTable::is_hashable(*make_cons(make_nil(), make_nil())));
+}
+
+TEST(FrameSlotsTest, HoldsFewValuesInline) {
+  std::vector<ValuePtr> values = {make_number(1), make_number(2)};
+  FrameSlots slots(values);
+  ASSERT_EQ(slots.size(), 2);
+  EXPECT_DOUBLE_EQ(slots[0]->as_number(), 1.0);
+  EXPECT_DOUBLE_EQ(slots[1]->as_number(), 2.0);
+  EXPECT_EQ(values[0], nullptr);  // Moved from.
+
+  slots.clear();
+  EXPECT_EQ(slots.size(), 0);
+  EXPECT_EQ(slots.begin(), slots.end());
+}
+
+TEST(FrameSlotsTest, SpillsManyValuesToTheHeap) {
+  std::vector<ValuePtr> values;
+  for (int i = 0; i < 10; ++i) {
+    values.push_back(make_number(i));
+  }
+  FrameSlots slots(values);
+  ASSERT_EQ(slots.size(), 10);
+  int expected = 0;
+  for (const ValuePtr& value : slots) {
+    EXPECT_DOUBLE_EQ(value->as_number(), expected++);
+  }
+}
+
 }  // namespace lisp
@@ -3,11 +3,13 @@
 #include <cctype>
 #include <cstddef>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace lisp {
 
-Tokenizer::Tokenizer(const std::string& input)
+Tokenizer::Tokenizer(std::string_view input)
     : input(input), position(0), length(input.length()) {}
 
 char Tokenizer::peek(size_t offset) const {
@@ -46,25 +48,41 @@ bool Tokenizer::skip_comment() {
 
 Token Tokenizer::read_number() {
   size_t const start_pos = position;
-  std::string number;
 
   if (peek() == '-' || peek() == '+') {
-    number += advance();
+    advance();
   }
 
   while (position < length && ((std::isdigit(peek()) != 0) || peek() == '.')) {
-    number += advance();
+    advance();
   }
 
-  return Token(TokenType::NUMBER, number, start_pos);
+  return Token(TokenType::NUMBER, input.substr(start_pos, position - start_pos),
+               start_pos);
 }
 
 Token Tokenizer::read_string() {
   size_t const start_pos = position;
-  std::string str;
 
   advance();  // skip opening quote
 
+  // Most literals have no escapes and are returned as a view of the input;
+  // the text is only copied once a backslash is seen.
+  size_t const text_start = position;
+  while (position < length && peek() != '"' && peek() != '\\') {
+    advance();
+  }
+
+  if (position >= length || peek() == '"') {
+    std::string_view const text =
+        input.substr(text_start, position - text_start);
+    if (position < length) {
+      advance();  // skip closing quote
+    }
+    return Token(TokenType::STRING, text, start_pos);
+  }
+
+  std::string str(input.substr(text_start, position - text_start));
   while (position < length && peek() != '"') {
     char const glyph = advance();
     if (glyph == '\\' && position < length) {
@@ -98,19 +116,19 @@ Token Tokenizer::read_string() {
     advance();  // skip closing quote
   }
 
-  return Token(TokenType::STRING, str, start_pos);
+  return Token(std::move(str), start_pos);
 }
 
 Token Tokenizer::read_symbol() {
   size_t const start_pos = position;
-  std::string symbol;
 
   while (position < length && (std::isspace(peek()) == 0) && peek() != '(' &&
          peek() != ')' && peek() != '"' && peek() != ';') {
-    symbol += advance();
+    advance();
   }
 
-  return Token(TokenType::SYMBOL, symbol, start_pos);
+  return Token(TokenType::SYMBOL, input.substr(start_pos, position - start_pos),
+               start_pos);
 }
 
 Token Tokenizer::next_token() {
@@ -137,6 +155,13 @@ Token Tokenizer::next_token() {
     case '\'':
       advance();
       return Token(TokenType::QUOTE, "'", start_pos);
+    case '#':
+      if (peek(1) == '(') {
+        advance();
+        advance();
+        return Token(TokenType::VECTOR_START, "#(", start_pos);
+      }
+      return read_symbol();
     case '"':
       return read_string();
     default:
@@ -154,9 +179,8 @@ std::vector<Token> Tokenizer::tokenize() {
   std::vector<Token> tokens;
 
   while (true) {
-    Token const token = next_token();
-    tokens.push_back(token);
-    if (token.type() == TokenType::EOF_TOKEN) {
+    tokens.push_back(next_token());
+    if (tokens.back().type() == TokenType::EOF_TOKEN) {
       break;
     }
   }
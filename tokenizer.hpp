@@ -1,39 +1,60 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace lisp {
 
 enum class TokenType : std::uint8_t {
-  LPAREN,  // (
-  RPAREN,  // )
-  NUMBER,  // 123, 3.14
-  STRING,  // "hello"
-  SYMBOL,  // +, car, define
-  QUOTE,   // '
+  LPAREN,        // (
+  VECTOR_START,  // #(
+  RPAREN,        // )
+  NUMBER,        // 123, 3.14
+  STRING,        // "hello"
+  SYMBOL,        // +, car, define
+  QUOTE,         // '
   EOF_TOKEN
 };
 
+// A token is a span of the tokenizer's input. Only a string literal
+// containing escape sequences owns a decoded copy of its text.
 struct Token {
  private:
   TokenType type_;
-  std::string value_;
+  std::string_view text_;
+  std::string unescaped_;
+  bool has_escapes_ = false;
   size_t position_;
 
  public:
-  Token(TokenType type, const std::string& value, size_t position)
-      : type_(type), value_(value), position_(position) {}
+  Token(TokenType type, std::string_view text, size_t position)
+      : type_(type), text_(text), position_(position) {}
+
+  // A STRING token whose escape sequences have been decoded into `unescaped`.
+  Token(std::string unescaped, size_t position)
+      : type_(TokenType::STRING),
+        unescaped_(std::move(unescaped)),
+        has_escapes_(true),
+        position_(position) {}
 
   TokenType type() const { return type_; }
-  const std::string& value() const { return value_; }
+  // The token's text (for a string literal, its decoded contents without the
+  // quotes). Unless the string had escapes, this views the tokenizer input.
+  std::string_view value() const {
+    return has_escapes_ ? std::string_view(unescaped_) : text_;
+  }
   size_t position() const { return position_; }
 };
 
+// Splits source text into tokens without copying it. The input is not owned:
+// it must outlive the Tokenizer and every Token it returns.
 class Tokenizer {
  private:
-  std::string input;
+  std::string_view input;
   size_t position;
   size_t length;
 
@@ -46,7 +67,7 @@ class Tokenizer {
   Token read_symbol();
 
  public:
-  explicit Tokenizer(const std::string& input);
+  explicit Tokenizer(std::string_view input);
   std::vector<Token> tokenize();
   Token next_token();
 };
@@ -1,85 +1,624 @@
 #include "value.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <memory>
-#include <sstream>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <streambuf>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "pool.hpp"
+
 namespace lisp {
 
-std::string Value::to_string() const {
-  switch (type) {
+namespace {
+
+// Range of the preallocated small numbers.
+constexpr int kSmallMin = -128;
+constexpr int kSmallMax = 1023;
+
+constexpr double kInt64Bound = 9223372036854775808.0;  // 2^63
+
+// True if `number` is integral and converts to int64_t without overflow.
+bool fits_int64(double number) {
+  return number == std::trunc(number) && number >= -kInt64Bound &&
+         number < kInt64Bound;
+}
+
+// Destinations for print_value: a growable string or a stream's buffer.
+// Both take characters a piece at a time, so printing builds no
+// intermediate strings.
+struct StringSink {
+  std::string& out;
+
+  void put(char c) { out.push_back(c); }
+  void write(std::string_view text) { out.append(text); }
+};
+
+// Records whether any write came up short, so the stream can be marked bad.
+struct StreamSink {
+  std::streambuf& out;
+  bool failed = false;
+
+  void put(char c) {
+    if (std::streambuf::traits_type::eq_int_type(
+            out.sputc(c), std::streambuf::traits_type::eof())) {
+      failed = true;
+    }
+  }
+  void write(std::string_view text) {
+    auto const size = static_cast<std::streamsize>(text.size());
+    if (out.sputn(text.data(), size) != size) {
+      failed = true;
+    }
+  }
+};
+
+template <typename Sink>
+void write_integer(Sink& sink, std::int64_t number) {
+  std::array<char, 24> digits;
+  char* const end =
+      std::to_chars(digits.data(), digits.data() + digits.size(), number).ptr;
+  sink.write(std::string_view(digits.data(), end - digits.data()));
+}
+
+// Integral doubles print without a fraction, others with six decimal
+// places (as std::to_string formats them).
+template <typename Sink>
+void write_double(Sink& sink, double number) {
+  if (fits_int64(number)) {
+    write_integer(sink, static_cast<std::int64_t>(number));
+    return;
+  }
+  // Enough for the longest fixed-point double, about 1.8e308.
+  std::array<char, 320> digits;
+  char* const end =
+      std::to_chars(digits.data(), digits.data() + digits.size(), number,
+                    std::chars_format::fixed, 6)
+          .ptr;
+  sink.write(std::string_view(digits.data(), end - digits.data()));
+}
+
+// Writes a value that has no elements printed as values of their own.
+template <typename Sink>
+void write_atom(Sink& sink, const Value& value) {
+  switch (value.type) {
     case ValueType::NIL:
-      return "nil";
-    case ValueType::NUMBER: {
-      double const number = as_number();
-      if (number == static_cast<int>(number)) {
-        return std::to_string(static_cast<int>(number));
+      sink.write("nil");
+      return;
+    case ValueType::NUMBER:
+      if (value.is_integer()) {
+        write_integer(sink, value.as_integer());
+      } else if (value.is_bignum()) {
+        sink.write(value.as_bignum().to_string());
+      } else {
+        write_double(sink, value.as_number());
       }
-      return std::to_string(number);
-    }
+      return;
     case ValueType::STRING:
-      return "\"" + as_string() + "\"";
+      sink.put('"');
+      sink.write(value.as_string());
+      sink.put('"');
+      return;
     case ValueType::SYMBOL:
-      return as_symbol();
-    case ValueType::CONS: {
-      std::ostringstream oss;
-      oss << "(";
-      ValuePtr current = std::const_pointer_cast<Value>(shared_from_this());
+      sink.write(value.as_symbol().name());
+      return;
+    case ValueType::F64ARRAY: {
+      sink.write("#f64(");
       bool first = true;
-
-      while (current && current->is_cons()) {
+      for (double const element : value.as_f64array().span()) {
         if (!first) {
-          oss << " ";
+          sink.put(' ');
         }
         first = false;
+        write_double(sink, element);
+      }
+      sink.put(')');
+      return;
+    }
+    case ValueType::HASHTABLE:
+      sink.write("#<hash-table>");
+      return;
+    case ValueType::PORT:
+      sink.write(value.as_port().is_input() ? "#<input-port>"
+                                            : "#<output-port>");
+      return;
+    case ValueType::BUILTIN:
+      sink.write("#<builtin>");
+      return;
+    case ValueType::LAMBDA:
+      sink.write("#<lambda>");
+      return;
+    case ValueType::LOCAL_REF:
+      sink.write(value.as_local_ref().name.name());
+      return;
+    case ValueType::GLOBAL_REF:
+      sink.write(value.as_global_ref().name.name());
+      return;
+    default:
+      sink.write("#<unknown>");
+      return;
+  }
+}
 
-        oss << current->car()->to_string();
-        current = current->cdr();
+// Prints `root` in one pass. Lists and vectors are walked with an explicit
+// stack of the containers still open, so a long list prints in constant
+// native stack and nesting depth is limited only by memory.
+template <typename Sink>
+void write_value(Sink& sink, const Value& root) {
+  // An open container: for a list, the cell whose car is being printed
+  // (or nullptr once a dotted tail is being printed); for a vector, the
+  // vector and the index of the element being printed.
+  struct Open {
+    const Value* container;
+    std::size_t index;
+  };
+  std::vector<Open> open;
+  const Value* value = &root;
+  for (;;) {
+    if (value->is_cons()) {
+      sink.put('(');
+      open.push_back({value, 0});
+      value = value->car().get();
+      continue;
+    }
+    if (value->is_vector() && !value->as_vector().empty()) {
+      sink.write("#(");
+      open.push_back({value, 0});
+      value = value->as_vector().front().get();
+      continue;
+    }
+    if (value->is_vector()) {
+      sink.write("#()");
+    } else {
+      write_atom(sink, *value);
+    }
 
-        if (current && !current->is_nil() && !current->is_cons()) {
-          oss << " . " << current->to_string();
-          break;
+    // `value` is done; move on to the next element of the innermost open
+    // container, closing those that have none left.
+    for (value = nullptr; value == nullptr;) {
+      if (open.empty()) {
+        return;
+      }
+      Open& top = open.back();
+      if (top.container == nullptr) {
+        // Finished a dotted tail.
+      } else if (top.container->is_cons()) {
+        const Value* const rest = top.container->cdr().get();
+        if (rest != nullptr && rest->is_cons()) {
+          sink.put(' ');
+          top.container = rest;
+          value = rest->car().get();
+          continue;
         }
+        if (rest != nullptr && !rest->is_nil()) {
+          sink.write(" . ");
+          top.container = nullptr;
+          value = rest;
+          continue;
+        }
+      } else if (++top.index < top.container->as_vector().size()) {
+        sink.put(' ');
+        value = top.container->as_vector()[top.index].get();
+        continue;
       }
-      oss << ")";
-      return oss.str();
+      sink.put(')');
+      open.pop_back();
     }
-    case ValueType::BUILTIN:
-      return "#<builtin>";
-    case ValueType::LAMBDA:
-      return "#<lambda>";
+  }
+}
+
+// Spreads the bits of `x` over the whole word (the splitmix64 finalizer), so
+// that consecutive integers and symbol ids do not land in consecutive slots
+// of a linearly probed table.
+std::uint64_t mix_hash(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// Whether `number` is exactly the integer held by `exact` (an int64_t or a
+// bignum), with no rounding on either side, so that key equality stays
+// transitive beyond 2^53.
+bool double_equals_exact(double number, const Value& exact) {
+  if (exact.is_integer()) {
+    return fits_int64(number) &&
+           static_cast<std::int64_t>(number) == exact.as_integer();
+  }
+  // Bignums lie outside int64_t's range; an integral double that does too
+  // is compared through its exact decimal digits.
+  if (!std::isfinite(number) || number != std::trunc(number) ||
+      fits_int64(number)) {
+    return false;
+  }
+  std::array<char, 320> digits;
+  char* const end =
+      std::to_chars(digits.data(), digits.data() + digits.size(), number,
+                    std::chars_format::fixed, 0)
+          .ptr;
+  std::optional<BigInt> const integer =
+      BigInt::parse(std::string_view(digits.data(), end - digits.data()));
+  return integer && *integer == exact.as_bignum();
+}
+
+// Hashes a hashable key consistently with keys_equal: a double equal to an
+// integer hashes as that integer. A bignum hashes as its nearest double,
+// which is exact whenever a double equals it.
+std::uint64_t hash_key(const Value& key) {
+  switch (key.type) {
+    case ValueType::NUMBER: {
+      if (key.is_integer()) {
+        return mix_hash(static_cast<std::uint64_t>(key.as_integer()));
+      }
+      double const number = key.as_number();
+      if (fits_int64(number)) {
+        return mix_hash(static_cast<std::uint64_t>(
+            static_cast<std::int64_t>(number)));
+      }
+      return mix_hash(std::bit_cast<std::uint64_t>(number));
+    }
+    case ValueType::STRING:
+      return mix_hash(std::hash<std::string_view>{}(key.as_string()));
+    default:
+      return mix_hash(key.as_symbol().id());
+  }
+}
+
+bool keys_equal(const Value& lhs, const Value& rhs) {
+  if (lhs.type != rhs.type) {
+    return false;
+  }
+  switch (lhs.type) {
+    case ValueType::NUMBER: {
+      bool const lhs_exact = lhs.is_integer() || lhs.is_bignum();
+      bool const rhs_exact = rhs.is_integer() || rhs.is_bignum();
+      if (lhs_exact && rhs_exact) {
+        // Exact integers are normalized, so an int64_t never equals a
+        // bignum.
+        if (lhs.is_integer() && rhs.is_integer()) {
+          return lhs.as_integer() == rhs.as_integer();
+        }
+        return lhs.is_bignum() && rhs.is_bignum() &&
+               lhs.as_bignum() == rhs.as_bignum();
+      }
+      if (!lhs_exact && !rhs_exact) {
+        return lhs.as_number() == rhs.as_number();
+      }
+      return lhs_exact ? double_equals_exact(rhs.as_number(), lhs)
+                       : double_equals_exact(lhs.as_number(), rhs);
+    }
+    case ValueType::STRING:
+      return lhs.as_string() == rhs.as_string();
+    default:
+      return lhs.as_symbol() == rhs.as_symbol();
+  }
+}
+
+template <typename... Args>
+ValuePtr allocate_value(Args&&... args) {
+  return std::allocate_shared<Value>(PoolAllocator<Value>(),
+                                     std::forward<Args>(args)...);
+}
+
+}  // namespace
+
+FrameSlots::FrameSlots(std::span<ValuePtr> values) : count(values.size()) {
+  if (count > kInlineCapacity) {
+    heap_values = std::make_unique<ValuePtr[]>(count);
+  }
+  std::move(values.begin(), values.end(), begin());
+}
+
+void FrameSlots::clear() {
+  for (ValuePtr& value : *this) {
+    value.reset();
+  }
+  heap_values.reset();
+  count = 0;
+}
+
+void Bindings::insert_or_assign(Symbol name, ValuePtr value) {
+  if (ValuePtr* const existing = find(name)) {
+    *existing = std::move(value);
+    return;
+  }
+  if (!table && inline_count < kInlineCapacity) {
+    inline_ids[inline_count] = name.id();
+    inline_values[inline_count] = std::move(value);
+    ++inline_count;
+    return;
+  }
+  use_table();
+  table->emplace(name.id(), std::move(value));
+}
+
+void Bindings::use_table() {
+  if (table) {
+    return;
+  }
+  table = std::make_unique<std::unordered_map<std::uint32_t, ValuePtr>>();
+  for (std::uint32_t i = 0; i < inline_count; ++i) {
+    table->emplace(inline_ids[i], std::move(inline_values[i]));
+  }
+  inline_count = 0;
+}
+
+void Bindings::clear() {
+  for (std::uint32_t i = 0; i < inline_count; ++i) {
+    inline_values[i].reset();
+  }
+  inline_count = 0;
+  table.reset();
+}
+
+bool HashTable::is_hashable(const Value& key) {
+  return key.is_number() || key.is_string() || key.is_symbol();
+}
+
+ValuePtr* HashTable::find(const Value& key) {
+  Slot* const slot = find_slot(key, hash_key(key));
+  return slot != nullptr ? &slot->value : nullptr;
+}
+
+void HashTable::insert_or_assign(ValuePtr key, ValuePtr value) {
+  std::uint64_t const hash = hash_key(*key);
+  if (Slot* const existing = find_slot(*key, hash)) {
+    existing->value = std::move(value);
+    return;
+  }
+  if ((used + 1) * 4 > slots.size() * 3) {
+    rehash(std::max<std::size_t>(8, std::bit_ceil((count + 1) * 2ULL)));
+  }
+  std::size_t const mask = slots.size() - 1;
+  std::size_t index = hash & mask;
+  while (slots[index].state == SlotState::FULL) {
+    index = (index + 1) & mask;
+  }
+  Slot& slot = slots[index];
+  if (slot.state == SlotState::EMPTY) {
+    ++used;
+  }
+  slot = Slot{std::move(key), std::move(value), hash, SlotState::FULL};
+  ++count;
+}
+
+bool HashTable::erase(const Value& key) {
+  Slot* const slot = find_slot(key, hash_key(key));
+  if (slot == nullptr) {
+    return false;
+  }
+  // The slot stays DELETED rather than EMPTY so that probes for keys
+  // stored past it still continue.
+  *slot = Slot{nullptr, nullptr, 0, SlotState::DELETED};
+  --count;
+  return true;
+}
+
+HashTable::Slot* HashTable::find_slot(const Value& key, std::uint64_t hash) {
+  if (slots.empty()) {
+    return nullptr;
+  }
+  std::size_t const mask = slots.size() - 1;
+  for (std::size_t index = hash & mask;; index = (index + 1) & mask) {
+    Slot& slot = slots[index];
+    if (slot.state == SlotState::EMPTY) {
+      return nullptr;
+    }
+    if (slot.state == SlotState::FULL && slot.hash == hash &&
+        keys_equal(*slot.key, key)) {
+      return &slot;
+    }
+  }
+}
+
+void HashTable::rehash(std::size_t capacity) {
+  std::vector<Slot> old_slots(capacity);
+  old_slots.swap(slots);
+  used = count;
+  std::size_t const mask = capacity - 1;
+  for (Slot& slot : old_slots) {
+    if (slot.state != SlotState::FULL) {
+      continue;
+    }
+    std::size_t index = slot.hash & mask;
+    while (slots[index].state == SlotState::FULL) {
+      index = (index + 1) & mask;
+    }
+    slots[index] = std::move(slot);
+  }
+}
+
+Environment::Environment(std::shared_ptr<Environment> parent, ValuePtr lambda,
+                         std::span<ValuePtr> slot_values)
+    : slots(slot_values),
+      callee(std::move(lambda)),
+      slot_names(&callee->as_lambda().params),
+      parent(std::move(parent)) {
+  gc_track();
+}
+
+void Environment::gc_track() {
+  gc_next = gc_head;
+  if (gc_head != nullptr) {
+    gc_head->gc_prev = this;
+  }
+  gc_head = this;
+  ++gc_count;
+}
+
+void Environment::gc_untrack() {
+  if (gc_prev != nullptr) {
+    gc_prev->gc_next = gc_next;
+  } else {
+    gc_head = gc_next;
+  }
+  if (gc_next != nullptr) {
+    gc_next->gc_prev = gc_prev;
+  }
+  --gc_count;
+  if (gc_old) {
+    --gc_old_count;
+  }
+}
+
+std::string NativeBuiltin::arity_error() const {
+  switch (arity()) {
+    case 0:
+      return name + " takes no arguments";
+    case 1:
+      return name + " requires exactly one argument";
+    case 2:
+      return name + " requires exactly two arguments";
     default:
-      return "#<unknown>";
+      return name + " requires exactly three arguments";
   }
 }
 
-ValuePtr make_nil() { return std::make_shared<Value>(ValueType::NIL); }
+std::string Value::to_string() const {
+  std::string text;
+  print_value(*this, text);
+  return text;
+}
 
-ValuePtr make_number(double n) { return std::make_shared<Value>(n); }
+void print_value(const Value& value, std::string& out) {
+  StringSink sink{out};
+  write_value(sink, value);
+}
+
+void print_value(const Value& value, std::ostream& out) {
+  // The sentry flushes a tied stream first, and fails on a stream that is
+  // already bad or has no buffer.
+  std::ostream::sentry const sentry(out);
+  if (!sentry) {
+    return;
+  }
+  StreamSink sink{*out.rdbuf()};
+  write_value(sink, value);
+  if (sink.failed) {
+    out.setstate(std::ios::badbit);
+  }
+}
+
+const ValuePtr& make_nil() {
+  static const ValuePtr nil = allocate_value(ValueType::NIL);
+  return nil;
+}
+
+const ValuePtr& make_true() {
+  static const ValuePtr true_symbol = allocate_value(intern("#t"));
+  return true_symbol;
+}
+
+const ValuePtr& make_false() {
+  static const ValuePtr false_symbol = allocate_value(intern("#f"));
+  return false_symbol;
+}
+
+ValuePtr make_number(double n) {
+  static const std::vector<ValuePtr> small_numbers = [] {
+    std::vector<ValuePtr> numbers;
+    numbers.reserve(kSmallMax - kSmallMin + 1);
+    for (int i = kSmallMin; i <= kSmallMax; ++i) {
+      numbers.push_back(allocate_value(static_cast<double>(i)));
+    }
+    return numbers;
+  }();
+
+  // -0.0 compares equal to 0 but is a distinct value, so it is not shared.
+  if (n >= kSmallMin && n <= kSmallMax && n == std::trunc(n) &&
+      !(n == 0 && std::signbit(n))) {
+    return small_numbers[static_cast<int>(n) - kSmallMin];
+  }
+  return allocate_value(n);
+}
+
+ValuePtr make_integer(std::int64_t n) {
+  static const std::vector<ValuePtr> small_integers = [] {
+    std::vector<ValuePtr> integers;
+    integers.reserve(kSmallMax - kSmallMin + 1);
+    for (std::int64_t i = kSmallMin; i <= kSmallMax; ++i) {
+      integers.push_back(allocate_value(i));
+    }
+    return integers;
+  }();
+
+  if (n >= kSmallMin && n <= kSmallMax) {
+    return small_integers[n - kSmallMin];
+  }
+  return allocate_value(n);
+}
+
+ValuePtr make_integer(const BigInt& n) {
+  if (std::optional<std::int64_t> const small = n.to_int64()) {
+    return make_integer(*small);
+  }
+  return allocate_value(n);
+}
+
+ValuePtr make_string(std::string text) {
+  return allocate_value(SharedString(std::move(text)));
+}
 
-ValuePtr make_string(const std::string& text) {
-  return std::make_shared<Value>(text, ValueType::STRING);
+ValuePtr make_string(SharedString text) {
+  return allocate_value(std::move(text));
 }
 
-ValuePtr make_symbol(const std::string& symbol) {
-  return std::make_shared<Value>(symbol, ValueType::SYMBOL);
+ValuePtr make_symbol(Symbol symbol) { return allocate_value(symbol); }
+
+ValuePtr make_symbol(std::string_view name) {
+  return make_symbol(intern(name));
 }
 
 ValuePtr make_cons(ValuePtr car, ValuePtr cdr) {
-  return std::make_shared<Value>(car, cdr);
+  return allocate_value(std::move(car), std::move(cdr));
+}
+
+ValuePtr make_vector(std::vector<ValuePtr> elements) {
+  return allocate_value(std::move(elements));
+}
+
+ValuePtr make_f64array(F64Array array) {
+  return allocate_value(std::move(array));
+}
+
+ValuePtr make_hash_table() { return allocate_value(HashTable()); }
+
+ValuePtr make_port(std::unique_ptr<Port> port) {
+  return allocate_value(std::move(port));
 }
 
 ValuePtr make_builtin(const BuiltinFunction& func) {
-  return std::make_shared<Value>(func);
+  return allocate_value(func);
+}
+
+ValuePtr make_native(std::string_view name, NativeFunction function) {
+  return allocate_value(NativeBuiltin{std::string(name), function});
 }
 
-ValuePtr make_lambda(const std::vector<std::string>& params,
+ValuePtr make_lambda(const std::vector<Symbol>& params,
                      const std::vector<ValuePtr>& body,
                      std::shared_ptr<Environment>&& closure) {
-  Lambda const lambda{params, body, std::move(closure)};
-  return std::make_shared<Value>(lambda);
+  return allocate_value(Lambda{params, body, std::move(closure)});
+}
+
+ValuePtr make_local_ref(Symbol name, std::uint32_t depth, std::uint32_t slot) {
+  return allocate_value(LocalRef{name, depth, slot});
+}
+
+ValuePtr make_global_ref(Symbol name) {
+  return allocate_value(GlobalRef{name});
 }
 
 }  // namespace lisp
\ No newline at end of file
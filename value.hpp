@@ -1,45 +1,189 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <map>
+#include <iosfwd>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "bigint.hpp"
+#include "f64array.hpp"
+#include "port.hpp"
+#include "shared_string.hpp"
+#include "symbol.hpp"
+
 namespace lisp {
 
 class Environment;
+struct Chunk;
 struct Value;
 
 using ValuePtr = std::shared_ptr<Value>;
 using BuiltinFunction =
     std::function<ValuePtr(const std::vector<ValuePtr>&, Environment&)>;
 
+// Fixed-arity builtins are plain functions that take their arguments
+// directly, so calling one needs neither an argument vector nor a
+// std::function. The variant index is the arity.
+using NativeFunction =
+    std::variant<ValuePtr (*)(),
+                 ValuePtr (*)(const ValuePtr&),
+                 ValuePtr (*)(const ValuePtr&, const ValuePtr&),
+                 ValuePtr (*)(const ValuePtr&, const ValuePtr&,
+                              const ValuePtr&)>;
+
+struct NativeBuiltin {
+  static constexpr std::size_t kMaxArity = 3;
+
+  std::string name;
+  NativeFunction function;
+
+  std::size_t arity() const { return function.index(); }
+
+  // The error reported when called with the wrong number of arguments.
+  std::string arity_error() const;
+
+  // Calls the function with args[0] .. args[arity() - 1]; the caller has
+  // already checked the argument count.
+  ValuePtr call(const ValuePtr* args) const {
+    switch (function.index()) {
+      case 0:
+        return std::get<0>(function)();
+      case 1:
+        return std::get<1>(function)(args[0]);
+      case 2:
+        return std::get<2>(function)(args[0], args[1]);
+      default:
+        return std::get<3>(function)(args[0], args[1], args[2]);
+    }
+  }
+};
+
 enum class ValueType : std::uint8_t {
   NIL,
   NUMBER,
   STRING,
   SYMBOL,
   CONS,
+  VECTOR,
+  F64ARRAY,
+  HASHTABLE,
+  PORT,
   BUILTIN,
-  LAMBDA
+  LAMBDA,
+  LOCAL_REF,
+  GLOBAL_REF
 };
 
 struct Lambda {
-  std::vector<std::string> params;
+  std::vector<Symbol> params;
   std::vector<ValuePtr> body;
   std::shared_ptr<Environment> closure;
+  // Bytecode for `body`, filled in by the VM on first call if not already
+  // compiled. The tree-walking evaluator ignores it.
+  mutable std::shared_ptr<const Chunk> code = nullptr;
+};
+
+// A variable reference resolved ahead of time to a lambda parameter: `depth`
+// frames up the environment chain, at index `slot` of that frame.
+struct LocalRef {
+  Symbol name;
+  std::uint32_t depth;
+  std::uint32_t slot;
+};
+
+// A reference resolved ahead of time to a binding of the global environment.
+// The first lookup caches the binding's cell, tagged with the serial number
+// of the Environment that owns it, so later lookups are a single load.
+struct GlobalRef {
+  Symbol name;
+  mutable std::uint64_t owner = 0;
+  mutable ValuePtr* cell = nullptr;
 };
 
+// A mutable map from keys (numbers, strings and symbols) to values, stored
+// as an open-addressing table with linear probing. Keys are matched as `=`
+// matches them, so 1 and 1.0 are the same key.
+class HashTable {
+ public:
+  HashTable() = default;
+  HashTable(HashTable&&) noexcept = default;
+  HashTable& operator=(HashTable&&) noexcept = default;
+
+  // True if `key` is of a type that can be used as a key.
+  static bool is_hashable(const Value& key);
+
+  std::size_t size() const { return count; }
+
+  // Returns the value stored under `key`, or nullptr if there is none.
+  ValuePtr* find(const Value& key);
+
+  // `key` must be hashable.
+  void insert_or_assign(ValuePtr key, ValuePtr value);
+
+  // Removes the entry for `key`; returns whether there was one.
+  bool erase(const Value& key);
+
+  template <typename Visitor>
+  void for_each(Visitor visit) const {
+    for (const Slot& slot : slots) {
+      if (slot.state == SlotState::FULL) {
+        visit(slot.key, slot.value);
+      }
+    }
+  }
+
+ private:
+  enum class SlotState : std::uint8_t { EMPTY, FULL, DELETED };
+
+  struct Slot {
+    ValuePtr key;
+    ValuePtr value;
+    std::uint64_t hash = 0;
+    SlotState state = SlotState::EMPTY;
+  };
+
+  // A power-of-two number of slots, at most three quarters of them FULL or
+  // DELETED so that every probe sequence reaches an EMPTY slot.
+  std::vector<Slot> slots;
+  std::uint32_t count = 0;  // FULL slots.
+  std::uint32_t used = 0;   // FULL or DELETED slots.
+
+  Slot* find_slot(const Value& key, std::uint64_t hash);
+  void rehash(std::size_t capacity);
+};
+
+// The large, rarely created payloads (builtins, lambdas and ports) are held
+// out of line so that the common values - numbers, symbols, strings and cons
+// cells - fit in a 64-byte object.
 struct Value : public std::enable_shared_from_this<Value> {
+  static inline const ValuePtr kNoValue = nullptr;
+
   ValueType type;
-  std::variant<std::nullptr_t,                 // NIL
-               double,                         // NUMBER
-               std::string,                    // STRING or SYMBOL
-               std::pair<ValuePtr, ValuePtr>,  // CONS
-               BuiltinFunction,                // BUILTIN
-               Lambda                          // LAMBDA
+  std::variant<std::nullptr_t,                           // NIL
+               double,                                   // NUMBER
+               std::int64_t,                             // NUMBER
+               BigInt,                                   // NUMBER
+               SharedString,                             // STRING
+               Symbol,                                   // SYMBOL
+               std::pair<ValuePtr, ValuePtr>,            // CONS
+               std::vector<ValuePtr>,                    // VECTOR
+               F64Array,                                 // F64ARRAY
+               HashTable,                                // HASHTABLE
+               std::unique_ptr<Port>,                    // PORT
+               std::unique_ptr<const BuiltinFunction>,  // BUILTIN
+               std::unique_ptr<const NativeBuiltin>,    // BUILTIN
+               std::unique_ptr<const Lambda>,           // LAMBDA
+               LocalRef,                                 // LOCAL_REF
+               GlobalRef                                 // GLOBAL_REF
                >
       data;
 
@@ -53,89 +197,419 @@ struct Value : public std::enable_shared_from_this<Value> {
     }
   }
 
-  // Constructor for a NUMBER.
+  // Constructor for a floating-point NUMBER.
   explicit Value(double number) : type(ValueType::NUMBER), data(number) {}
 
+  // Constructor for an integer NUMBER.
+  explicit Value(std::int64_t number)
+      : type(ValueType::NUMBER), data(number) {}
+
+  // Constructor for an integer NUMBER too large for int64_t.
+  explicit Value(BigInt number)
+      : type(ValueType::NUMBER), data(std::move(number)) {}
+
   // Constructor for a STRING.
-  explicit Value(const std::string& text)
-      : type(ValueType::STRING), data(text) {}
+  explicit Value(SharedString text)
+      : type(ValueType::STRING), data(std::move(text)) {}
 
-  // Constructor for either a STRING or a SYMBOL.
-  Value(const std::string& text, ValueType type) : type(type), data(text) {}
+  // Constructor for a SYMBOL.
+  explicit Value(Symbol symbol) : type(ValueType::SYMBOL), data(symbol) {}
 
   // Constructor for a CONS.
-  Value(ValuePtr& car, ValuePtr& cdr)
-      : type(ValueType::CONS), data(std::make_pair(car, cdr)) {}
+  Value(ValuePtr car, ValuePtr cdr)
+      : type(ValueType::CONS),
+        data(std::in_place_type<std::pair<ValuePtr, ValuePtr>>,
+             std::move(car), std::move(cdr)) {}
+
+  // Constructor for a VECTOR.
+  explicit Value(std::vector<ValuePtr> elements)
+      : type(ValueType::VECTOR), data(std::move(elements)) {}
+
+  // Constructor for an F64ARRAY.
+  explicit Value(F64Array array)
+      : type(ValueType::F64ARRAY), data(std::move(array)) {}
+
+  // Constructor for a HASHTABLE.
+  explicit Value(HashTable table)
+      : type(ValueType::HASHTABLE), data(std::move(table)) {}
+
+  // Constructor for a PORT.
+  explicit Value(std::unique_ptr<Port> port)
+      : type(ValueType::PORT), data(std::move(port)) {}
 
   // Constructor for a BUILTIN function.
-  explicit Value(BuiltinFunction func) : type(ValueType::BUILTIN), data(func) {}
+  explicit Value(BuiltinFunction func)
+      : type(ValueType::BUILTIN),
+        data(std::make_unique<const BuiltinFunction>(std::move(func))) {}
+
+  // Constructor for a fixed-arity BUILTIN function.
+  explicit Value(NativeBuiltin native)
+      : type(ValueType::BUILTIN),
+        data(std::make_unique<const NativeBuiltin>(std::move(native))) {}
 
   // Constructor for a LAMBDA.
-  explicit Value(const Lambda& lambda)
-      : type(ValueType::LAMBDA), data(lambda) {}
+  explicit Value(Lambda lambda)
+      : type(ValueType::LAMBDA),
+        data(std::make_unique<const Lambda>(std::move(lambda))) {}
+
+  // Constructor for a LOCAL_REF.
+  explicit Value(const LocalRef& ref) : type(ValueType::LOCAL_REF), data(ref) {}
+
+  // Constructor for a GLOBAL_REF.
+  explicit Value(const GlobalRef& ref)
+      : type(ValueType::GLOBAL_REF), data(ref) {}
 
   bool is_nil() const { return type == ValueType::NIL; }
   bool is_number() const { return type == ValueType::NUMBER; }
+  // True for a NUMBER held exactly as an integer that fits in int64_t.
+  bool is_integer() const {
+    return std::holds_alternative<std::int64_t>(data);
+  }
+  // True for an integer NUMBER outside the range of int64_t.
+  bool is_bignum() const { return std::holds_alternative<BigInt>(data); }
   bool is_string() const { return type == ValueType::STRING; }
   bool is_symbol() const { return type == ValueType::SYMBOL; }
   bool is_cons() const { return type == ValueType::CONS; }
+  bool is_vector() const { return type == ValueType::VECTOR; }
+  bool is_f64array() const { return type == ValueType::F64ARRAY; }
+  bool is_hash_table() const { return type == ValueType::HASHTABLE; }
+  bool is_port() const { return type == ValueType::PORT; }
   bool is_builtin() const { return type == ValueType::BUILTIN; }
+  bool is_native() const {
+    return std::holds_alternative<std::unique_ptr<const NativeBuiltin>>(data);
+  }
   bool is_lambda() const { return type == ValueType::LAMBDA; }
+  bool is_local_ref() const { return type == ValueType::LOCAL_REF; }
+  bool is_global_ref() const { return type == ValueType::GLOBAL_REF; }
 
-  double as_number() const { return std::get<double>(data); }
-  const std::string& as_string() const { return std::get<std::string>(data); }
-  const std::string& as_symbol() const { return std::get<std::string>(data); }
+  // The value of either kind of NUMBER, converted to double if needed.
+  double as_number() const {
+    if (is_integer()) {
+      return static_cast<double>(std::get<std::int64_t>(data));
+    }
+    if (is_bignum()) {
+      return std::get<BigInt>(data).to_double();
+    }
+    return std::get<double>(data);
+  }
+  std::int64_t as_integer() const { return std::get<std::int64_t>(data); }
+  const BigInt& as_bignum() const { return std::get<BigInt>(data); }
+  // The characters of a STRING; flattens it if it is a rope.
+  std::string_view as_string() const {
+    return std::get<SharedString>(data).view();
+  }
+  const SharedString& as_shared_string() const {
+    return std::get<SharedString>(data);
+  }
+  Symbol as_symbol() const { return std::get<Symbol>(data); }
   const std::pair<ValuePtr, ValuePtr>& as_cons() const {
     return std::get<std::pair<ValuePtr, ValuePtr>>(data);
   }
+  const std::vector<ValuePtr>& as_vector() const {
+    return std::get<std::vector<ValuePtr>>(data);
+  }
+  std::vector<ValuePtr>& as_vector() {
+    return std::get<std::vector<ValuePtr>>(data);
+  }
+  const F64Array& as_f64array() const { return std::get<F64Array>(data); }
+  F64Array& as_f64array() { return std::get<F64Array>(data); }
+  const HashTable& as_hash_table() const {
+    return std::get<HashTable>(data);
+  }
+  HashTable& as_hash_table() { return std::get<HashTable>(data); }
+  Port& as_port() const { return *std::get<std::unique_ptr<Port>>(data); }
   const BuiltinFunction& as_builtin() const {
-    return std::get<BuiltinFunction>(data);
+    return *std::get<std::unique_ptr<const BuiltinFunction>>(data);
   }
-  const Lambda& as_lambda() const { return std::get<Lambda>(data); }
+  const NativeBuiltin& as_native() const {
+    return *std::get<std::unique_ptr<const NativeBuiltin>>(data);
+  }
+  const Lambda& as_lambda() const {
+    return *std::get<std::unique_ptr<const Lambda>>(data);
+  }
+  const LocalRef& as_local_ref() const { return std::get<LocalRef>(data); }
+  const GlobalRef& as_global_ref() const { return std::get<GlobalRef>(data); }
 
-  ValuePtr car() const { return is_cons() ? as_cons().first : nullptr; }
+  // car() and cdr() return references to avoid reference count traffic when
+  // walking lists; for a non-cons they refer to a null ValuePtr.
+  const ValuePtr& car() const { return is_cons() ? as_cons().first : kNoValue; }
 
-  ValuePtr cdr() const { return is_cons() ? as_cons().second : nullptr; }
+  const ValuePtr& cdr() const {
+    return is_cons() ? as_cons().second : kNoValue;
+  }
 
+  // The printed representation, as print_value writes it.
   std::string to_string() const;
 };
 
+// Writes the printed representation of `value` to `out` (appending, for a
+// string) in a single iterative pass, without building a string per
+// element, so large and deeply nested structures print in linear time.
+void print_value(const Value& value, std::ostream& out);
+void print_value(const Value& value, std::string& out);
+
+// The parameter values of a call frame. Up to kInlineCapacity values are
+// stored in the object itself, so calling a lambda with few parameters does
+// not allocate; larger frames use a heap array.
+class FrameSlots {
+ public:
+  static constexpr std::size_t kInlineCapacity = 4;
+
+  FrameSlots() = default;
+
+  // Moves `values` into the slots.
+  explicit FrameSlots(std::span<ValuePtr> values);
+
+  FrameSlots(const FrameSlots&) = delete;
+  FrameSlots& operator=(const FrameSlots&) = delete;
+
+  std::size_t size() const { return count; }
+  ValuePtr& operator[](std::size_t index) { return begin()[index]; }
+  const ValuePtr& operator[](std::size_t index) const {
+    return begin()[index];
+  }
+
+  ValuePtr* begin() {
+    return heap_values ? heap_values.get() : inline_values.data();
+  }
+  ValuePtr* end() { return begin() + count; }
+  const ValuePtr* begin() const {
+    return heap_values ? heap_values.get() : inline_values.data();
+  }
+  const ValuePtr* end() const { return begin() + count; }
+
+  void clear();
+
+ private:
+  std::array<ValuePtr, kInlineCapacity> inline_values;
+  std::unique_ptr<ValuePtr[]> heap_values;
+  std::size_t count = 0;
+};
+
+// The names bound in an Environment other than its parameter slots, keyed
+// by symbol id. The first kInlineCapacity bindings (enough for the internal
+// defines of a typical lambda frame) are stored in the object itself and
+// searched linearly; once there are more, as in the global environment,
+// they move to a hash table.
+class Bindings {
+ public:
+  static constexpr std::size_t kInlineCapacity = 3;
+
+  Bindings() = default;
+  Bindings(const Bindings&) = delete;
+  Bindings& operator=(const Bindings&) = delete;
+
+  // Returns the value bound to `name`, or nullptr if there is none.
+  ValuePtr* find(Symbol name) {
+    std::uint32_t const id = name.id();
+    if (table) {
+      auto const entry = table->find(id);
+      return entry != table->end() ? &entry->second : nullptr;
+    }
+    for (std::uint32_t i = 0; i < inline_count; ++i) {
+      if (inline_ids[i] == id) {
+        return &inline_values[i];
+      }
+    }
+    return nullptr;
+  }
+
+  void insert_or_assign(Symbol name, ValuePtr value);
+
+  // Moves to the hash table now rather than when the inline entries run
+  // out, so that the address of every value stays fixed from here on.
+  void use_table();
+
+  template <typename Visitor>
+  void for_each_value(Visitor visit) const {
+    if (table) {
+      for (const auto& entry : *table) {
+        visit(entry.second);
+      }
+      return;
+    }
+    for (std::uint32_t i = 0; i < inline_count; ++i) {
+      visit(inline_values[i]);
+    }
+  }
+
+  void clear();
+
+ private:
+  std::array<std::uint32_t, kInlineCapacity> inline_ids{};
+  std::uint32_t inline_count = 0;
+  std::array<ValuePtr, kInlineCapacity> inline_values;
+  std::unique_ptr<std::unordered_map<std::uint32_t, ValuePtr>> table;
+};
+
+// A frame of variable bindings. Frames created for lambda calls hold the
+// parameters in a fixed-size array of slots, addressed by index from
+// LocalRefs; any other names (globals, internal defines) live in `bindings`.
+//
+// Every Environment is also linked into a global list so that
+// collect_cycles() can find frames kept alive only by closure cycles.
 class Environment : public std::enable_shared_from_this<Environment> {
  private:
-  std::map<std::string, ValuePtr> bindings;
+  FrameSlots slots;
+  ValuePtr callee;  // The LAMBDA whose call created this frame, if any.
+  const std::vector<Symbol>* slot_names = nullptr;  // Owned by callee.
+  Bindings bindings;
   std::shared_ptr<Environment> parent = nullptr;
+  // Identifies a root Environment in the GlobalRef caches; zero otherwise.
+  std::uint64_t serial = 0;
+  static inline std::uint64_t last_serial = 0;
+
+  Environment* gc_prev = nullptr;
+  Environment* gc_next = nullptr;
+  static inline Environment* gc_head = nullptr;
+  static inline std::size_t gc_count = 0;
+  // Set once the frame has survived a collection.
+  bool gc_old = false;
+  static inline std::size_t gc_old_count = 0;
+  // Scratch state of the collection in progress.
+  bool gc_reachable = false;
+  long gc_refs = 0;
+
+  void gc_track();
+  void gc_untrack();
+
+  friend class CycleCollector;
+
+  // Returns the index of the slot named `name`, or -1. Searches from the
+  // back so that a repeated parameter name refers to its last occurrence.
+  std::ptrdiff_t find_slot(Symbol name) const {
+    if (slot_names != nullptr) {
+      for (auto i = static_cast<std::ptrdiff_t>(slot_names->size()) - 1;
+           i >= 0; --i) {
+        if ((*slot_names)[i] == name) {
+          return i;
+        }
+      }
+    }
+    return -1;
+  }
 
  public:
   explicit Environment(std::shared_ptr<Environment> parent = nullptr)
-      : parent(parent) {}
+      : parent(std::move(parent)) {
+    if (!this->parent) {
+      serial = ++last_serial;
+      bindings.use_table();
+    }
+    gc_track();
+  }
+
+  // Creates a call frame for `lambda` (a LAMBDA value) whose slots hold its
+  // parameters, moved from `slot_values` (which must be the same length as
+  // the parameter list).
+  Environment(std::shared_ptr<Environment> parent, ValuePtr lambda,
+              std::span<ValuePtr> slot_values);
+
+  Environment(const Environment&) = delete;
+  Environment& operator=(const Environment&) = delete;
 
-  void define(const std::string& name, ValuePtr value) {
-    bindings[name] = std::move(value);
+  ~Environment() { gc_untrack(); }
+
+  // Number of Environments currently alive.
+  static std::size_t live_count() { return gc_count; }
+  // Number of those created since the last collection.
+  static std::size_t young_count() { return gc_count - gc_old_count; }
+
+  void define(Symbol name, ValuePtr value) {
+    if (std::ptrdiff_t const slot = find_slot(name); slot >= 0) {
+      slots[slot] = std::move(value);
+      return;
+    }
+    bindings.insert_or_assign(name, std::move(value));
   }
 
-  ValuePtr lookup(const std::string& name) {
+  void define(std::string_view name, ValuePtr value) {
+    define(intern(name), std::move(value));
+  }
+
+  ValuePtr lookup(Symbol name) {
     for (Environment* env = this; env != nullptr; env = env->parent.get()) {
-      const auto& binding = env->bindings.find(name);
-      if (binding != env->bindings.end()) {
-        return binding->second;
+      if (std::ptrdiff_t const slot = env->find_slot(name); slot >= 0) {
+        return env->slots[slot];
+      }
+      if (const ValuePtr* binding = env->bindings.find(name)) {
+        return *binding;
       }
     }
     return nullptr;
   }
 
+  ValuePtr lookup(std::string_view name) { return lookup(intern(name)); }
+
+  // Indexed load for a resolved LocalRef.
+  const ValuePtr& lookup(std::uint32_t depth, std::uint32_t slot) const {
+    const Environment* env = this;
+    for (; depth > 0; --depth) {
+      env = env->parent.get();
+    }
+    return env->slots[slot];
+  }
+
+  // Returns the cell holding the binding of `ref` in this Environment, which
+  // must be the root of its chain, or nullptr if the name is unbound. A
+  // root's cells never move and redefinition assigns to the existing cell,
+  // so once found the cell is cached in `ref`.
+  ValuePtr* global_cell(const GlobalRef& ref) {
+    if (ref.owner == serial) {
+      return ref.cell;
+    }
+    ValuePtr* const cell = bindings.find(ref.name);
+    if (cell != nullptr) {
+      ref.owner = serial;
+      ref.cell = cell;
+    }
+    return cell;
+  }
+
+  // The Environment at the end of the parent chain.
+  Environment& root() {
+    Environment* env = this;
+    while (env->parent) {
+      env = env->parent.get();
+    }
+    return *env;
+  }
+
   std::shared_ptr<Environment> extend() {
     return std::make_shared<Environment>(shared_from_this());
   }
 };
 
-ValuePtr make_nil();
+// nil and the symbols #t and #f are preallocated singletons shared by every
+// use, so predicates and list terminators never allocate.
+const ValuePtr& make_nil();
+const ValuePtr& make_true();
+const ValuePtr& make_false();
+// Numbers are either exact integers or doubles. Integers are held as
+// int64_t, or as a BigInt only when they do not fit. Integral values in a
+// small range around zero are preallocated and shared, so counters and
+// indices do not allocate.
 ValuePtr make_number(double n);
-ValuePtr make_string(const std::string& text);
-ValuePtr make_symbol(const std::string& symbol);
+ValuePtr make_integer(std::int64_t n);
+// Returns an int64_t integer if `n` fits in one, otherwise a bignum.
+ValuePtr make_integer(const BigInt& n);
+// Strings share their characters (see SharedString); make_string takes
+// ownership of `text` without copying it.
+ValuePtr make_string(std::string text);
+ValuePtr make_string(SharedString text);
+ValuePtr make_symbol(Symbol symbol);
+ValuePtr make_symbol(std::string_view name);
 ValuePtr make_cons(ValuePtr car, ValuePtr cdr);
+ValuePtr make_vector(std::vector<ValuePtr> elements);
+ValuePtr make_f64array(F64Array array);
+ValuePtr make_hash_table();
+ValuePtr make_port(std::unique_ptr<Port> port);
 ValuePtr make_builtin(const BuiltinFunction& func);
-ValuePtr make_lambda(const std::vector<std::string>& params,
+ValuePtr make_native(std::string_view name, NativeFunction function);
+ValuePtr make_lambda(const std::vector<Symbol>& params,
                      const std::vector<ValuePtr>& body,
                      std::shared_ptr<Environment>&& closure);
+ValuePtr make_local_ref(Symbol name, std::uint32_t depth, std::uint32_t slot);
+ValuePtr make_global_ref(Symbol name);
 
 }  // namespace lisp
\ No newline at end of file
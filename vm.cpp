@@ -0,0 +1,197 @@
+#include "vm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "compiler.hpp"
+#include "evaluator.hpp"
+#include "pool.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+ValuePtr VM::run(std::shared_ptr<const Chunk> chunk, Environment& env) {
+  std::size_t const base_frames = frames.size();
+  std::size_t const base_stack = stack.size();
+  if (base_frames == 0) {
+    globals = &env.root();
+  }
+  frames.push_back(Frame{std::move(chunk), 0, &env, nullptr, base_stack});
+
+  try {
+    while (true) {
+      Frame& frame = frames.back();
+      const Instruction& instruction = frame.chunk->code[frame.pc++];
+
+      switch (instruction.op) {
+        case OpCode::CONSTANT:
+          stack.push_back(frame.chunk->constants[instruction.a]);
+          break;
+
+        case OpCode::LOAD_LOCAL:
+          stack.push_back(frame.env->lookup(instruction.a, instruction.b));
+          break;
+
+        case OpCode::LOAD_NAME: {
+          Symbol const name = frame.chunk->names[instruction.a];
+          ValuePtr value = frame.env->lookup(name);
+          if (!value) {
+            throw EvalError("Unbound symbol: " + name.name());
+          }
+          stack.push_back(std::move(value));
+          break;
+        }
+
+        case OpCode::LOAD_GLOBAL: {
+          const GlobalRef& ref =
+              frame.chunk->constants[instruction.a]->as_global_ref();
+          const ValuePtr* const cell = globals->global_cell(ref);
+          if (cell == nullptr) {
+            throw EvalError("Unbound symbol: " + ref.name.name());
+          }
+          stack.push_back(*cell);
+          break;
+        }
+
+        case OpCode::DEFINE:
+          frame.env->define(frame.chunk->names[instruction.a], stack.back());
+          break;
+
+        case OpCode::POP:
+          stack.pop_back();
+          break;
+
+        case OpCode::JUMP:
+          frame.pc = instruction.a;
+          break;
+
+        case OpCode::JUMP_IF_NIL: {
+          bool const is_nil = stack.back()->is_nil();
+          stack.pop_back();
+          if (is_nil) {
+            frame.pc = instruction.a;
+          }
+          break;
+        }
+
+        case OpCode::MAKE_LAMBDA: {
+          const LambdaTemplate& lambda = frame.chunk->lambdas[instruction.a];
+          ValuePtr closure = make_lambda(lambda.params, lambda.body,
+                                         frame.env->shared_from_this());
+          closure->as_lambda().code = lambda.code;
+          stack.push_back(std::move(closure));
+          break;
+        }
+
+        case OpCode::CALL:
+          call(instruction.a, false);
+          break;
+
+        case OpCode::TAIL_CALL:
+          call(instruction.a, true);
+          break;
+
+        case OpCode::RETURN: {
+          ValuePtr result = std::move(stack.back());
+          stack.resize(frame.stack_base);
+          frames.pop_back();
+          if (frames.size() == base_frames) {
+            return result;
+          }
+          stack.push_back(std::move(result));
+          break;
+        }
+
+        case OpCode::RAISE:
+          throw EvalError(frame.chunk->errors[instruction.a]);
+      }
+    }
+  } catch (...) {
+    frames.resize(base_frames);
+    stack.resize(base_stack);
+    throw;
+  }
+}
+
+void VM::append_roots(std::vector<ValuePtr>& values,
+                      std::vector<Environment*>& environments) const {
+  values.insert(values.end(), stack.begin(), stack.end());
+  for (const Frame& frame : frames) {
+    environments.push_back(frame.env);
+  }
+}
+
+void VM::call(std::uint32_t argc, bool tail) {
+  std::size_t const func_index = stack.size() - argc - 1;
+
+  // Fixed-arity builtins take their arguments straight from the stack.
+  if (stack[func_index]->is_native()) {
+    const NativeBuiltin& native = stack[func_index]->as_native();
+    if (argc != native.arity()) {
+      throw EvalError(native.arity_error());
+    }
+    ValuePtr result = native.call(stack.data() + func_index + 1);
+    stack.resize(func_index);
+    stack.push_back(std::move(result));
+    return;
+  }
+
+  ValuePtr func = std::move(stack[func_index]);
+  std::span<ValuePtr> const args(stack.data() + func_index + 1, argc);
+
+  if (func->is_builtin()) {
+    ValuePtr result = call_builtin(func->as_builtin(), args, builtin_args,
+                                   *frames.back().env);
+    stack.resize(func_index);
+    stack.push_back(std::move(result));
+    return;
+  }
+
+  if (!func->is_lambda()) {
+    throw EvalError("Cannot call non-function: " + func->to_string());
+  }
+
+  const Lambda& lambda = func->as_lambda();
+
+  if (argc != lambda.params.size()) {
+    throw EvalError("Lambda expects " + std::to_string(lambda.params.size()) +
+                    " arguments, got " + std::to_string(argc));
+  }
+  if (lambda.body.empty()) {
+    throw EvalError("lambda requires at least one body expression");
+  }
+
+  // Closures created by the tree-walking Evaluator are compiled on first
+  // call.
+  if (!lambda.code) {
+    lambda.code = Compiler::compile_body(lambda.body);
+  }
+
+  evaluator.safe_point(*frames.back().env);
+
+  std::shared_ptr<const Chunk> code = lambda.code;
+  auto env = std::allocate_shared<Environment>(
+      PoolAllocator<Environment>(), lambda.closure, std::move(func), args);
+  stack.resize(func_index);
+
+  if (tail) {
+    Frame& frame = frames.back();
+    stack.resize(frame.stack_base);
+    frame.chunk = std::move(code);
+    frame.pc = 0;
+    frame.env = env.get();
+    frame.owner = std::move(env);
+    return;
+  }
+
+  Environment* const env_ptr = env.get();
+  frames.push_back(
+      Frame{std::move(code), 0, env_ptr, std::move(env), stack.size()});
+}
+
+}  // namespace lisp
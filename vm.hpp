@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "compiler.hpp"
+#include "value.hpp"
+
+namespace lisp {
+
+class Evaluator;
+
+// Stack-based virtual machine for Chunks produced by Compiler.
+//
+// Operands and intermediate results live on a single value stack; each
+// active lambda call has a Frame recording its chunk, program counter,
+// environment and the stack depth at entry. Lambda calls push a Frame
+// instead of recursing in C++, and TAIL_CALL reuses the caller's Frame, so
+// neither deep nor tail recursion grows the C++ stack.
+//
+// Errors are reported by throwing EvalError, as the tree-walking Evaluator
+// does.
+class VM {
+ private:
+  struct Frame {
+    std::shared_ptr<const Chunk> chunk;
+    std::uint32_t pc = 0;
+    Environment* env = nullptr;
+    std::shared_ptr<Environment> owner;  // Keeps a call frame's env alive.
+    std::size_t stack_base = 0;
+  };
+
+  // The owner, whose safe point runs before each lambda frame is created.
+  Evaluator& evaluator;
+  std::vector<ValuePtr> stack;
+  std::vector<Frame> frames;
+  // The root of the environment the outermost run() was given, where
+  // LOAD_GLOBAL looks up its GLOBAL_REFs.
+  Environment* globals = nullptr;
+  // Reused storage for the argument vector of variadic builtins.
+  std::vector<ValuePtr> builtin_args;
+
+  // Pops `argc` arguments and the function below them and calls it. For a
+  // lambda this pushes a new Frame (or, if `tail`, replaces the current
+  // one); for a builtin the result is pushed.
+  void call(std::uint32_t argc, bool tail);
+
+ public:
+  explicit VM(Evaluator& evaluator) : evaluator(evaluator) {}
+
+  // Appends the operand stack and the environments of the active frames to
+  // the collector roots.
+  void append_roots(std::vector<ValuePtr>& values,
+                    std::vector<Environment*>& environments) const;
+
+  // Runs `chunk` in `env` and returns the value of its final RETURN.
+  ValuePtr run(std::shared_ptr<const Chunk> chunk, Environment& env);
+};
+
+}  // namespace lisp